@@ -1,9 +1,111 @@
 #include <mpi.h>
 #include <iostream>
 #include <bits/stdc++.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
 
 using namespace std;
 
+// Usage: mpirun -np N ./MPI_Hello_world [rankfile]
+//
+// Besides the hello line, every rank reports where it runs (host, bound
+// cores, current core, NUMA node, socket), all rank pairs are measured
+// with a ping-pong, and rank 0 prints a placement report and writes an
+// Open MPI rankfile (mpirun --rankfile) that puts the master on the
+// best-connected slot and the heavy workers on the next best ones.
+
+const int LATENCY_BYTES = 8;
+const int LATENCY_ITERS = 1000;
+const int BANDWIDTH_BYTES = 4 << 20;  // 4 MB
+const int BANDWIDTH_ITERS = 10;
+
+// Per-rank placement, gathered to rank 0 as raw bytes
+struct Placement {
+    char host[MPI_MAX_PROCESSOR_NAME];
+    char cpus[256];   // affinity mask as a cpu list, e.g. "0-3,8"
+    int cpu;          // core the rank is running on now
+    int boundCpu;     // the single core in the affinity mask, -1 if several
+    cpu_set_t allowed;  // the affinity mask itself
+    int numa;
+    int socket;
+};
+
+// Read the first integer from a sysfs file, -1 if unavailable
+int readSysInt(const string& path) {
+    ifstream in(path);
+    int value;
+    return (in >> value) ? value : -1;
+}
+
+// NUMA node of a cpu: /sys/devices/system/cpu/cpuN contains a "nodeM" link
+int numaNodeOf(int cpu) {
+    string dir = "/sys/devices/system/cpu/cpu" + to_string(cpu);
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) return -1;
+    int node = -1;
+    while (dirent* e = readdir(d)) {
+        if (strncmp(e->d_name, "node", 4) == 0 && isdigit((unsigned char)e->d_name[4])) {
+            node = atoi(e->d_name + 4);
+            break;
+        }
+    }
+    closedir(d);
+    return node;
+}
+
+// Affinity mask as a compact cpu list
+string affinityList() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return "?";
+
+    string list;
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+        if (!CPU_ISSET(c, &set)) continue;
+        int end = c;
+        while (end + 1 < CPU_SETSIZE && CPU_ISSET(end + 1, &set)) ++end;
+        if (!list.empty()) list += ",";
+        list += end > c ? to_string(c) + "-" + to_string(end) : to_string(c);
+        c = end;
+    }
+    return list;
+}
+
+// The core a process with this mask is pinned to, or -1 if it allows several
+int boundCore(const cpu_set_t& set) {
+    if (CPU_COUNT(&set) != 1) return -1;
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+        if (CPU_ISSET(c, &set)) return c;
+    return -1;
+}
+
+// Next cpu of mask at or after start, wrapping around, that is not in
+// skip; -1 if every allowed cpu is in skip
+int nextAllowed(const cpu_set_t& mask, int start, const set<int>& skip) {
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+        int c = (start + i) % CPU_SETSIZE;
+        if (CPU_ISSET(c, &mask) && !skip.count(c)) return c;
+    }
+    return -1;
+}
+
+// Ping-pong between ranks a and b; returns one-way time per message
+double pingPong(int rank, int a, int b, vector<char>& buf, int bytes, int iters) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int i = 0; i < iters; ++i) {
+        if (rank == a) {
+            MPI_Send(buf.data(), bytes, MPI_CHAR, b, 0, MPI_COMM_WORLD);
+            MPI_Recv(buf.data(), bytes, MPI_CHAR, b, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else if (rank == b) {
+            MPI_Recv(buf.data(), bytes, MPI_CHAR, a, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(buf.data(), bytes, MPI_CHAR, a, 0, MPI_COMM_WORLD);
+        }
+    }
+    return (MPI_Wtime() - start) / (2.0 * iters);
+}
+
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
 
@@ -22,6 +124,116 @@ int main(int argc, char** argv) {
               << ", rank " << world_rank << " out of " << world_size
               << " processors" << std::endl;
 
+    // 1. Where does this rank run?
+    Placement me = {};
+    snprintf(me.host, sizeof(me.host), "%s", processor_name);
+    snprintf(me.cpus, sizeof(me.cpus), "%s", affinityList().c_str());
+    me.cpu = sched_getcpu();
+    CPU_ZERO(&me.allowed);
+    if (sched_getaffinity(0, sizeof(me.allowed), &me.allowed) != 0) {
+        // Unknown mask: allow the online cpus
+        for (long c = 0; c < sysconf(_SC_NPROCESSORS_ONLN) && c < CPU_SETSIZE; ++c)
+            CPU_SET(c, &me.allowed);
+    }
+    me.boundCpu = boundCore(me.allowed);
+    me.numa = numaNodeOf(me.cpu);
+    me.socket = readSysInt("/sys/devices/system/cpu/cpu" + to_string(me.cpu) + "/topology/physical_package_id");
+
+    vector<Placement> all(world_size);
+    MPI_Gather(&me, sizeof(Placement), MPI_BYTE, all.data(), sizeof(Placement), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    // 2. Ping-pong matrix: every pair measured in turn while the others wait
+    vector<double> latency(world_size * world_size, 0.0), bandwidth(world_size * world_size, 0.0);
+    vector<char> buf(BANDWIDTH_BYTES);
+    for (int a = 0; a < world_size; ++a) {
+        for (int b = a + 1; b < world_size; ++b) {
+            double lat = pingPong(world_rank, a, b, buf, LATENCY_BYTES, LATENCY_ITERS);
+            double bwTime = pingPong(world_rank, a, b, buf, BANDWIDTH_BYTES, BANDWIDTH_ITERS);
+            if (world_rank == a) {
+                latency[a * world_size + b] = latency[b * world_size + a] = lat;
+                bandwidth[a * world_size + b] = bandwidth[b * world_size + a] = BANDWIDTH_BYTES / bwTime;
+            }
+        }
+    }
+    // Each entry was filled by its lower rank; a max-reduction merges them
+    MPI_Allreduce(MPI_IN_PLACE, latency.data(), world_size * world_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, bandwidth.data(), world_size * world_size, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    // 3. Report and rankfile on rank 0
+    if (world_rank == 0) {
+        cout << "\nRank placement:" << endl;
+        cout << "rank host cpu numa socket bound_cpus" << endl;
+        for (int r = 0; r < world_size; ++r)
+            cout << r << " " << all[r].host << " " << all[r].cpu << " " << all[r].numa << " "
+                 << all[r].socket << " " << all[r].cpus << endl;
+
+        cout << fixed << setprecision(2);
+        cout << "\nLatency matrix (us, " << LATENCY_BYTES << " B one-way):" << endl;
+        for (int a = 0; a < world_size; ++a) {
+            for (int b = 0; b < world_size; ++b)
+                cout << setw(9) << latency[a * world_size + b] * 1e6;
+            cout << endl;
+        }
+        cout << "\nBandwidth matrix (MB/s, " << (BANDWIDTH_BYTES >> 20) << " MB messages):" << endl;
+        for (int a = 0; a < world_size; ++a) {
+            for (int b = 0; b < world_size; ++b)
+                cout << setw(9) << bandwidth[a * world_size + b] / 1e6;
+            cout << endl;
+        }
+
+        // Best-connected slot: lowest mean latency to every other rank
+        vector<double> meanLatency(world_size, 0.0);
+        for (int a = 0; a < world_size; ++a) {
+            for (int b = 0; b < world_size; ++b)
+                meanLatency[a] += latency[a * world_size + b];
+            if (world_size > 1) meanLatency[a] /= world_size - 1;
+        }
+        vector<int> order(world_size);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int x, int y) { return meanLatency[x] < meanLatency[y]; });
+
+        // Rankfile slots. sched_getcpu() is only where the scheduler happened
+        // to run the rank, so a core is kept only for ranks pinned to exactly
+        // one; the others go round-robin over the cpus their mask allows,
+        // preferring cores no other rank on the host has taken yet.
+        map<string, set<int>> taken;
+        for (int r = 0; r < world_size; ++r)
+            if (all[r].boundCpu >= 0) taken[all[r].host].insert(all[r].boundCpu);
+        map<string, int> nextSlot;
+        vector<int> slot(world_size);
+        for (int r = 0; r < world_size; ++r) {
+            const Placement& p = all[order[r]];
+            if (p.boundCpu >= 0) {
+                slot[r] = p.boundCpu;
+                continue;
+            }
+            int& next = nextSlot[p.host];
+            int c = nextAllowed(p.allowed, next, taken[p.host]);
+            if (c < 0) c = nextAllowed(p.allowed, next, {});   // oversubscribed: share
+            if (c < 0) c = 0;                                    // empty mask
+            taken[p.host].insert(c);
+            slot[r] = c;
+            next = c + 1;
+        }
+
+        cout << "\nSuggested placement (new rank <- current slot, mean latency, rankfile slot):" << endl;
+        for (int r = 0; r < world_size; ++r)
+            cout << "  rank " << r << (r == 0 ? " (master)" : "") << " <- " << all[order[r]].host
+                 << " cpu " << all[order[r]].cpu << " (" << meanLatency[order[r]] * 1e6 << " us), slot "
+                 << slot[r] << (all[order[r]].boundCpu >= 0 ? " (bound core)" : " (round-robin over allowed cpus)")
+                 << endl;
+
+        string path = argc > 1 ? argv[1] : "rankfile.txt";
+        ofstream out(path);
+        if (!out) {
+            cerr << "Cannot write " << path << endl;
+        } else {
+            for (int r = 0; r < world_size; ++r)
+                out << "rank " << r << "=" << all[order[r]].host << " slot=" << slot[r] << "\n";
+            cout << "Rankfile written to " << path << " (use: mpirun --rankfile " << path << " ...)" << endl;
+        }
+    }
+
     MPI_Finalize();
     return 0;
 }
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <vector>
 
+#include "instrument.hpp"
+
 
 using namespace std;
 
@@ -13,6 +15,7 @@ int main(int argc, char** argv) {
    int world_rank, world_size;
    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+   INSTR_SET_RANK(world_rank);
 
 
    if (world_size < 5) {
@@ -32,16 +35,22 @@ int main(int argc, char** argv) {
        data = {100.0, 5.0, 2.0, 10.0, 4.0};
 
 
-       // Send the data to each slave
-       for (int rank = 1; rank <= 4; ++rank) {
-           MPI_Send(data.data(), array_size, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD);
-       }
+       double results[4];
+       {
+           INSTR_SCOPE("communication");
 
+           // Send the data to each slave
+           for (int rank = 1; rank <= 4; ++rank) {
+               MPI_Send(data.data(), array_size, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD);
+           }
+           INSTR_COUNT("bytes_sent", 4 * array_size * sizeof(double));
 
-       // Receive results from slaves
-       double results[4];
-       for (int rank = 1; rank <= 4; ++rank) {
-           MPI_Recv(&results[rank - 1], 1, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+           // Receive results from slaves
+           for (int rank = 1; rank <= 4; ++rank) {
+               MPI_Recv(&results[rank - 1], 1, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+           }
+           INSTR_COUNT("bytes_received", 4 * sizeof(double));
        }
 
 
@@ -55,9 +64,14 @@ int main(int argc, char** argv) {
 
    } else if (world_rank >= 1 && world_rank <= 4) {
        // Slaves receive the data
-       MPI_Recv(data.data(), array_size, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+       {
+           INSTR_SCOPE("communication");
+           MPI_Recv(data.data(), array_size, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+           INSTR_COUNT("bytes_received", array_size * sizeof(double));
+       }
 
 
+       INSTR_SCOPE("compute");
        double result = 0.0;
 
 
@@ -96,9 +110,13 @@ int main(int argc, char** argv) {
 
        // Send result back to master
        MPI_Send(&result, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+       INSTR_COUNT("bytes_sent", sizeof(double));
    }
 
 
+   INSTR_REPORT("mpi_master_slave_profile.json");
+
+
    MPI_Finalize();
    return 0;
 }
@@ -0,0 +1,97 @@
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+
+// Compressed-sparse-row directed graph with integer vertex IDs, and an
+// edge-list loader. Shared by the shortest-path programs.
+//
+// Edge-list format: one "u v w" per line (0-based vertex IDs, weight as a
+// number); blank lines and lines starting with '#' are skipped.
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Edge {
+    int u, v;
+    double w;
+};
+
+struct CSRGraph {
+    int numVertices = 0;
+    std::vector<long long> offsets;   // edges of u are [offsets[u], offsets[u+1])
+    std::vector<int> targets;
+    std::vector<double> weights;
+    std::vector<std::string> names;   // optional labels for printing
+
+    long long numEdges() const { return targets.size(); }
+
+    std::string name(int v) const {
+        return v < (int)names.size() ? names[v] : std::to_string(v);
+    }
+};
+
+// Build the CSR arrays with a counting sort on the source vertex
+inline CSRGraph buildCSR(int numVertices, const std::vector<Edge>& edges) {
+    CSRGraph g;
+    g.numVertices = numVertices;
+    g.offsets.assign(numVertices + 1, 0);
+    for (const auto& e : edges)
+        g.offsets[e.u + 1]++;
+    for (int u = 0; u < numVertices; ++u)
+        g.offsets[u + 1] += g.offsets[u];
+
+    g.targets.resize(edges.size());
+    g.weights.resize(edges.size());
+    std::vector<long long> next(g.offsets.begin(), g.offsets.end() - 1);
+    for (const auto& e : edges) {
+        long long k = next[e.u]++;
+        g.targets[k] = e.v;
+        g.weights[k] = e.w;
+    }
+    return g;
+}
+
+// Stream the edges of an edge-list file to visit(const Edge&) without
+// keeping them. Returns false (after printing the reason) if the file is
+// unreadable or malformed.
+template <typename Visit>
+bool forEachEdge(const std::string& path, Visit visit) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        std::cerr << "Cannot open edge list " << path << std::endl;
+        return false;
+    }
+
+    char line[256];
+    long long lineNo = 0;
+    while (std::fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        const char* p = line;
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        Edge e;
+        if (std::sscanf(p, "%d %d %lf", &e.u, &e.v, &e.w) != 3 || e.u < 0 || e.v < 0) {
+            std::cerr << path << ":" << lineNo << ": expected \"u v w\"" << std::endl;
+            std::fclose(f);
+            return false;
+        }
+        visit(e);
+    }
+    std::fclose(f);
+    return true;
+}
+
+// Read an edge list; numVertices becomes the largest ID + 1
+inline bool loadEdgeList(const std::string& path, std::vector<Edge>& edges, int& numVertices) {
+    edges.clear();
+    numVertices = 0;
+    return forEachEdge(path, [&](const Edge& e) {
+        edges.push_back(e);
+        if (e.u + 1 > numVertices) numVertices = e.u + 1;
+        if (e.v + 1 > numVertices) numVertices = e.v + 1;
+    });
+}
+
+#endif
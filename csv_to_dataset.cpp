@@ -0,0 +1,196 @@
+// Convert a numeric CSV file to the columnar dataset format of dataset.hpp.
+//
+// Build: g++ -std=c++17 -O2 csv_to_dataset.cpp -o csv_to_dataset
+// Run:   ./csv_to_dataset input.csv output.bin [--float32]
+//
+// Every column is stored as float64 (or float32 with --float32). A first
+// line that does not parse as numbers is taken as the column names.
+// The CSV is streamed twice: the first pass counts rows and checks that
+// every field is a number, the second fills per-column buffers of
+// CHUNK_ROWS values and writes each one to its column's region with
+// pwrite, so memory use does not depend on the file size. The output is
+// written to output.bin.tmp and renamed into place only on success.
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "dataset.hpp"
+
+using namespace std;
+
+const size_t CHUNK_ROWS = 1 << 16;
+
+// Split a CSV line in place on commas; strips the line ending
+vector<char*> splitFields(char* line) {
+    vector<char*> fields;
+    line[strcspn(line, "\r\n")] = '\0';
+    char* p = line;
+    fields.push_back(p);
+    while ((p = strchr(p, ',')) != nullptr) {
+        *p++ = '\0';
+        fields.push_back(p);
+    }
+    return fields;
+}
+
+bool parseNumber(const char* s, double& value) {
+    while (*s == ' ' || *s == '\t') ++s;
+    char* end;
+    value = strtod(s, &end);
+    if (end == s) return false;
+    while (*end == ' ' || *end == '\t') ++end;
+    return *end == '\0';
+}
+
+bool isBlank(const char* line) {
+    return line[strspn(line, " \t\r\n")] == '\0';
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " input.csv output.bin [--float32]" << endl;
+        return 1;
+    }
+    string inPath = argv[1], outPath = argv[2];
+    uint32_t type = argc > 3 && strcmp(argv[3], "--float32") == 0 ? COL_FLOAT32 : COL_FLOAT64;
+    size_t width = columnTypeSize(type);
+
+    FILE* in = fopen(inPath.c_str(), "r");
+    if (in == nullptr) {
+        cerr << "Cannot open " << inPath << endl;
+        return 1;
+    }
+
+    // Pass 1: column names, column count, row count, field syntax
+    char* line = nullptr;
+    size_t capacity = 0;
+    vector<string> names;
+    size_t numColumns = 0;
+    uint64_t numRows = 0;
+    bool hasHeader = false;
+    long long lineNo = 0;
+    while (getline(&line, &capacity, in) != -1) {
+        ++lineNo;
+        if (isBlank(line)) continue;
+        vector<char*> fields = splitFields(line);
+        if (numColumns == 0) {
+            numColumns = fields.size();
+            double value;
+            hasHeader = !parseNumber(fields[0], value);
+            for (size_t c = 0; c < numColumns; ++c)
+                names.push_back(hasHeader ? string(fields[c]) : "c" + to_string(c));
+            if (hasHeader) continue;
+        }
+        if (fields.size() != numColumns) {
+            cerr << inPath << ":" << lineNo << ": expected " << numColumns << " fields, got " << fields.size() << endl;
+            return 1;
+        }
+        for (size_t c = 0; c < numColumns; ++c) {
+            double value;
+            if (!parseNumber(fields[c], value)) {
+                cerr << inPath << ":" << lineNo << ": field " << c + 1 << " is not a number" << endl;
+                return 1;
+            }
+        }
+        ++numRows;
+    }
+    if (numColumns == 0) {
+        cerr << inPath << ": no data" << endl;
+        return 1;
+    }
+
+    vector<ColumnInfo> columns(numColumns);
+    for (size_t c = 0; c < numColumns; ++c) {
+        memset(&columns[c], 0, sizeof(ColumnInfo));
+        strncpy(columns[c].name, names[c].c_str(), sizeof(columns[c].name) - 1);
+        columns[c].type = type;
+    }
+    uint64_t fileSize = layoutColumns(columns, numRows);
+
+    string tmpPath = outPath + ".tmp";
+    int out = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0 || ftruncate(out, fileSize) != 0) {
+        cerr << "Cannot create " << tmpPath << endl;
+        if (out >= 0) unlink(tmpPath.c_str());
+        return 1;
+    }
+    DatasetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, sizeof(DATASET_MAGIC));
+    header.version = DATASET_VERSION;
+    header.numColumns = numColumns;
+    header.numRows = numRows;
+    bool ok = pwrite(out, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+              pwrite(out, columns.data(), numColumns * sizeof(ColumnInfo), sizeof(header)) ==
+                  (ssize_t)(numColumns * sizeof(ColumnInfo));
+
+    // Pass 2: values, one chunk of rows at a time
+    vector<vector<char>> chunks(numColumns, vector<char>(CHUNK_ROWS * width));
+    uint64_t row = 0, chunkStart = 0;
+    size_t inChunk = 0;
+    auto flush = [&]() {
+        for (size_t c = 0; c < numColumns && ok; ++c) {
+            size_t bytes = inChunk * width;
+            ok = pwrite(out, chunks[c].data(), bytes, columns[c].offset + chunkStart * width) == (ssize_t)bytes;
+        }
+        chunkStart += inChunk;
+        inChunk = 0;
+    };
+
+    rewind(in);
+    lineNo = 0;
+    bool skippedHeader = !hasHeader;
+    while (ok && getline(&line, &capacity, in) != -1) {
+        ++lineNo;
+        if (isBlank(line)) continue;
+        if (!skippedHeader) {
+            skippedHeader = true;
+            continue;
+        }
+        // Pass 1 validated every line, so a mismatch here means the input
+        // changed underneath us
+        vector<char*> fields = splitFields(line);
+        if (fields.size() != numColumns || row == numRows) {
+            ok = false;
+            break;
+        }
+        for (size_t c = 0; c < numColumns && ok; ++c) {
+            double value;
+            ok = parseNumber(fields[c], value);
+            if (type == COL_FLOAT32)
+                reinterpret_cast<float*>(chunks[c].data())[inChunk] = (float)value;
+            else
+                reinterpret_cast<double*>(chunks[c].data())[inChunk] = value;
+        }
+        if (!ok) break;
+        ++row;
+        if (++inChunk == CHUNK_ROWS) flush();
+    }
+    if (ok && row != numRows) ok = false;
+    if (ok && inChunk > 0) flush();
+    free(line);
+    fclose(in);
+
+    if (close(out) != 0 || !ok || rename(tmpPath.c_str(), outPath.c_str()) != 0) {
+        cerr << "Error writing " << outPath << " (" << inPath << " changed or the disk is full)" << endl;
+        unlink(tmpPath.c_str());
+        return 1;
+    }
+
+    // Column names only while they fit on a line
+    const size_t NAME_LIMIT = 8;
+    cout << "Wrote " << outPath << ": " << row << " rows, " << numColumns << " "
+         << (type == COL_FLOAT32 ? "float32" : "float64") << " columns";
+    if (numColumns <= NAME_LIMIT) {
+        cout << " (";
+        for (size_t c = 0; c < numColumns; ++c)
+            cout << (c ? ", " : "") << columns[c].name;
+        cout << ")";
+    }
+    cout << endl;
+    return 0;
+}
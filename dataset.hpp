@@ -0,0 +1,265 @@
+#ifndef DATASET_HPP
+#define DATASET_HPP
+
+// Columnar binary dataset, memory-mapped for zero-copy reads. Shared by
+// the clustering/VQ programs and the MPI reducers; csv_to_dataset.cpp
+// writes it.
+//
+// File layout (little-endian, as written by the host):
+//   DatasetHeader                       32 bytes
+//   ColumnInfo[numColumns]              64 bytes each
+//   column 0 values, column 1 values... each numRows values of its type,
+//                                       starting on a 64-byte boundary
+//
+// Dataset::open maps only the pages that hold the requested rows of each
+// column, so an MPI rank that opens its own block [begin, end) pages in
+// just that slice, and ranks on one host share the page cache.
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum ColumnType : uint32_t {
+    COL_FLOAT32 = 0,
+    COL_FLOAT64 = 1,
+    COL_INT32 = 2,
+    COL_INT64 = 3,
+};
+
+const char DATASET_MAGIC[8] = {'C', 'O', 'L', 'D', 'A', 'T', 'A', '1'};
+const uint32_t DATASET_VERSION = 1;
+const uint64_t DATASET_ALIGN = 64;
+
+struct DatasetHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numColumns;
+    uint64_t numRows;
+    uint64_t reserved;
+};
+
+struct ColumnInfo {
+    char name[48];
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t offset;   // byte offset of the first value in the file
+};
+
+inline size_t columnTypeSize(uint32_t type) {
+    switch (type) {
+        case COL_FLOAT32: case COL_INT32: return 4;
+        case COL_FLOAT64: case COL_INT64: return 8;
+        default: return 0;
+    }
+}
+
+template <typename T> struct ColumnTypeOf;
+template <> struct ColumnTypeOf<float> { static const uint32_t value = COL_FLOAT32; };
+template <> struct ColumnTypeOf<double> { static const uint32_t value = COL_FLOAT64; };
+template <> struct ColumnTypeOf<int32_t> { static const uint32_t value = COL_INT32; };
+template <> struct ColumnTypeOf<int64_t> { static const uint32_t value = COL_INT64; };
+
+// Assign 64-byte aligned offsets to the columns; returns the file size
+inline uint64_t layoutColumns(std::vector<ColumnInfo>& columns, uint64_t numRows) {
+    uint64_t offset = sizeof(DatasetHeader) + columns.size() * sizeof(ColumnInfo);
+    for (auto& c : columns) {
+        offset = (offset + DATASET_ALIGN - 1) / DATASET_ALIGN * DATASET_ALIGN;
+        c.offset = offset;
+        offset += numRows * columnTypeSize(c.type);
+    }
+    return offset;
+}
+
+// The mapped rows [first, first + size) of one column; index 0 is row first
+template <typename T>
+struct ColumnView {
+    const T* data = nullptr;
+    uint64_t first = 0;
+    uint64_t size = 0;
+
+    const T& operator[](uint64_t i) const { return data[i]; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+};
+
+class Dataset {
+public:
+    Dataset() = default;
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+    ~Dataset() { close(); }
+
+    // Map rows [rowBegin, rowEnd) of every column (clamped to the file).
+    // Returns false, after printing the reason, if the file is unusable.
+    bool open(const std::string& path, uint64_t rowBegin = 0, uint64_t rowEnd = UINT64_MAX) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Cannot open dataset " << path << std::endl;
+            return false;
+        }
+        bool ok = readLayout(fd, path) && mapColumns(fd, path, rowBegin, rowEnd);
+        ::close(fd);   // the mappings stay valid
+        if (!ok) close();
+        return ok;
+    }
+
+    void close() {
+        for (auto& m : maps_)
+            if (m.base != nullptr) munmap(m.base, m.length);
+        maps_.clear();
+        columns_.clear();
+        numRows_ = rowBegin_ = rowEnd_ = 0;
+    }
+
+    uint64_t numRows() const { return numRows_; }   // in the whole file
+    uint64_t rowBegin() const { return rowBegin_; }
+    uint64_t rowEnd() const { return rowEnd_; }
+    uint64_t mappedRows() const { return rowEnd_ - rowBegin_; }
+    int numColumns() const { return columns_.size(); }
+    std::string columnName(int c) const { return columns_[c].name; }
+    uint32_t columnType(int c) const { return columns_[c].type; }
+
+    int findColumn(const std::string& name) const {
+        for (size_t c = 0; c < columns_.size(); ++c)
+            if (name == columns_[c].name) return c;
+        return -1;
+    }
+
+    // Zero-copy view of a column; empty (with a message) if T is not its type
+    template <typename T>
+    ColumnView<T> column(int c) const {
+        ColumnView<T> view;
+        if (c < 0 || c >= numColumns() || columns_[c].type != ColumnTypeOf<T>::value) {
+            std::cerr << "Dataset column " << c << " is missing or not of the requested type" << std::endl;
+            return view;
+        }
+        view.data = reinterpret_cast<const T*>(maps_[c].data);
+        view.first = rowBegin_;
+        view.size = mappedRows();
+        return view;
+    }
+
+    // Call f(i, value) for every mapped row of column c, i counted from
+    // rowBegin(); reads straight from the typed view, one dispatch per column
+    template <typename F>
+    void forEachValue(int c, F f) const {
+        switch (columns_[c].type) {
+            case COL_FLOAT32: visit(column<float>(c), f); break;
+            case COL_FLOAT64: visit(column<double>(c), f); break;
+            case COL_INT32: visit(column<int32_t>(c), f); break;
+            default: visit(column<int64_t>(c), f); break;
+        }
+    }
+
+    // Any numeric column read as double; row is a file row inside the mapped range
+    double at(int c, uint64_t row) const {
+        const char* p = maps_[c].data + (row - rowBegin_) * columnTypeSize(columns_[c].type);
+        switch (columns_[c].type) {
+            case COL_FLOAT32: return *reinterpret_cast<const float*>(p);
+            case COL_FLOAT64: return *reinterpret_cast<const double*>(p);
+            case COL_INT32: return *reinterpret_cast<const int32_t*>(p);
+            default: return (double)*reinterpret_cast<const int64_t*>(p);
+        }
+    }
+
+private:
+    struct Mapping {
+        void* base = nullptr;        // page-aligned start passed to munmap
+        size_t length = 0;
+        const char* data = nullptr;  // first mapped row
+    };
+
+    std::vector<ColumnInfo> columns_;
+    std::vector<Mapping> maps_;
+    uint64_t numRows_ = 0, rowBegin_ = 0, rowEnd_ = 0;
+
+    template <typename T, typename F>
+    static void visit(const ColumnView<T>& view, F& f) {
+        for (uint64_t i = 0; i < view.size; ++i) f(i, view[i]);
+    }
+
+    bool readLayout(int fd, const std::string& path) {
+        struct stat st;
+        DatasetHeader header;
+        if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            std::memcmp(header.magic, DATASET_MAGIC, sizeof(DATASET_MAGIC)) != 0) {
+            std::cerr << path << ": not a dataset file" << std::endl;
+            return false;
+        }
+        if (header.version != DATASET_VERSION) {
+            std::cerr << path << ": unsupported dataset version " << header.version << std::endl;
+            return false;
+        }
+
+        // Bound every size by the file before trusting it, so a corrupt
+        // header cannot cause a huge allocation or an overflowing check
+        uint64_t fileSize = st.st_size;
+        uint64_t tableEnd = sizeof(header) + (uint64_t)header.numColumns * sizeof(ColumnInfo);
+        if (tableEnd > fileSize) {
+            std::cerr << path << ": truncated column table" << std::endl;
+            return false;
+        }
+        columns_.resize(header.numColumns);
+        size_t bytes = columns_.size() * sizeof(ColumnInfo);
+        if (pread(fd, columns_.data(), bytes, sizeof(header)) != (ssize_t)bytes) {
+            std::cerr << path << ": truncated column table" << std::endl;
+            return false;
+        }
+        for (auto& c : columns_) {
+            c.name[sizeof(c.name) - 1] = '\0';
+            size_t width = columnTypeSize(c.type);
+            if (width == 0 || c.offset < tableEnd || c.offset > fileSize ||
+                header.numRows > (fileSize - c.offset) / width) {
+                std::cerr << path << ": column " << c.name << " is corrupt or truncated" << std::endl;
+                return false;
+            }
+        }
+        numRows_ = header.numRows;
+        return true;
+    }
+
+    bool mapColumns(int fd, const std::string& path, uint64_t rowBegin, uint64_t rowEnd) {
+        rowEnd_ = rowEnd < numRows_ ? rowEnd : numRows_;
+        rowBegin_ = rowBegin < rowEnd_ ? rowBegin : rowEnd_;
+
+        const uint64_t page = sysconf(_SC_PAGESIZE);
+        maps_.resize(columns_.size());
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            size_t width = columnTypeSize(columns_[c].type);
+            uint64_t from = columns_[c].offset + rowBegin_ * width;
+            uint64_t to = columns_[c].offset + rowEnd_ * width;
+            if (from == to) continue;   // nothing to map for an empty range
+
+            uint64_t aligned = from / page * page;
+            void* base = mmap(nullptr, to - aligned, PROT_READ, MAP_SHARED, fd, aligned);
+            if (base == MAP_FAILED) {
+                std::cerr << path << ": mmap failed" << std::endl;
+                return false;
+            }
+            madvise(base, to - aligned, MADV_SEQUENTIAL);
+            maps_[c].base = base;
+            maps_[c].length = to - aligned;
+            maps_[c].data = static_cast<const char*>(base) + (from - aligned);
+        }
+        return true;
+    }
+};
+
+// Block [begin, end) of numRows rows for one of parts workers, as in
+// mpi_array_divide.cpp; the last part takes the remainder.
+inline void blockRange(uint64_t numRows, int parts, int index, uint64_t& begin, uint64_t& end) {
+    uint64_t chunk = numRows / parts;
+    begin = chunk * index;
+    end = index == parts - 1 ? numRows : begin + chunk;
+}
+
+#endif
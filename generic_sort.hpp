@@ -0,0 +1,311 @@
+#ifndef GENERIC_SORT_HPP
+#define GENERIC_SORT_HPP
+
+// Header-only generic sort over random-access iterators.
+//
+//   sorting::sort(first, last);                               // ascending
+//   sorting::sort(first, last, std::greater<>());             // descending
+//   sorting::sort(recs.begin(), recs.end(), std::less<>(),
+//                 [](const Record &r) { return r.key; });     // by projected key
+//
+// Ranges are iterator based, so sizes are only limited by difference_type.
+// When the comparator is std::less / std::greater and the projected key is
+// an integral or floating-point type, sort() switches to an LSD radix sort
+// (O(n), one pass per key byte); otherwise it runs the same introsort as
+// quick_sort.cpp.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sorting {
+
+// Projection that returns its argument (std::identity is C++20)
+struct Identity {
+    template <typename T>
+    constexpr T &&operator()(T &&x) const noexcept { return std::forward<T>(x); }
+};
+
+namespace detail {
+
+const std::ptrdiff_t INSERTION_THRESHOLD = 16;   // ranges this small go to insertion sort
+const std::ptrdiff_t NINTHER_THRESHOLD = 128;    // ranges larger than this use a ninther pivot
+const std::ptrdiff_t PARALLEL_CUTOFF = 10000;    // ranges larger than this are sorted as tasks
+const std::ptrdiff_t RADIX_THRESHOLD = 256;      // smaller ranges stay on the comparison path
+
+// comp(proj(a), proj(b)) in one place
+template <typename Compare, typename Proj>
+struct ProjectedLess {
+    Compare &comp;
+    Proj &proj;
+
+    template <typename A, typename B>
+    bool operator()(A &&a, B &&b) const {
+        return std::invoke(comp, std::invoke(proj, std::forward<A>(a)), std::invoke(proj, std::forward<B>(b)));
+    }
+};
+
+template <typename It, typename Less>
+It medianOfThree(It a, It b, It c, Less &less) {
+    if (less(*a, *b)) {
+        if (less(*b, *c))
+            return b;
+        return less(*a, *c) ? c : a;
+    }
+    if (less(*a, *c))
+        return a;
+    return less(*b, *c) ? c : b;
+}
+
+// Median-of-3 pivot, or Tukey's ninther for large ranges
+template <typename It, typename Less>
+It choosePivot(It first, It last, Less &less) {
+    auto n = last - first;
+    It mid = first + n / 2;
+    if (n > NINTHER_THRESHOLD) {
+        auto s = n / 8;
+        It a = medianOfThree(first, first + s, first + 2 * s, less);
+        It b = medianOfThree(mid - s, mid, mid + s, less);
+        It c = medianOfThree(last - 1 - 2 * s, last - 1 - s, last - 1, less);
+        return medianOfThree(a, b, c, less);
+    }
+    return medianOfThree(first, mid, last - 1, less);
+}
+
+template <typename It, typename Less>
+void insertionSort(It first, It last, Less &less) {
+    if (first == last)
+        return;
+    for (It i = first + 1; i != last; ++i) {
+        auto key = std::move(*i);
+        It j = i;
+        while (j != first && less(key, *(j - 1))) {
+            *j = std::move(*(j - 1));
+            --j;
+        }
+        *j = std::move(key);
+    }
+}
+
+// Three-way partition around a copy of the pivot: afterwards
+// [first, lt) < pivot, [lt, gt) == pivot and [gt, last) > pivot
+template <typename It, typename Less>
+std::pair<It, It> partition(It first, It last, It pivotIt, Less &less) {
+    auto pivot = *pivotIt;
+    It lt = first, i = first, gt = last;
+    while (i < gt) {
+        if (less(*i, pivot))
+            std::iter_swap(lt++, i++);
+        else if (less(pivot, *i))
+            std::iter_swap(i, --gt);
+        else
+            ++i;
+    }
+    return {lt, gt};
+}
+
+// Recurse on the smaller side and loop on the larger one; heapsort
+// takes over once depthLimit levels have been used up
+template <typename It, typename Less>
+void introSort(It first, It last, int depthLimit, Less less) {
+    while (last - first > INSERTION_THRESHOLD) {
+        if (depthLimit-- == 0) {
+            std::make_heap(first, last, less);
+            std::sort_heap(first, last, less);
+            return;
+        }
+
+        auto bounds = partition(first, last, choosePivot(first, last, less), less);
+        It sFirst, sLast;
+        if (bounds.first - first < last - bounds.second) {
+            sFirst = first;
+            sLast = bounds.first;
+            first = bounds.second;
+        } else {
+            sFirst = bounds.second;
+            sLast = last;
+            last = bounds.first;
+        }
+
+        if (sLast - sFirst > PARALLEL_CUTOFF) {
+#ifdef _OPENMP
+            #pragma omp task firstprivate(sFirst, sLast, depthLimit, less)
+#endif
+            introSort(sFirst, sLast, depthLimit, less);
+        } else {
+            introSort(sFirst, sLast, depthLimit, less);
+        }
+    }
+    insertionSort(first, last, less);
+}
+
+// Comparators the radix path understands: +1 ascending, -1 descending, 0 other
+template <typename Compare, typename Key>
+constexpr int radixOrder() {
+    if (std::is_same<Compare, std::less<>>::value || std::is_same<Compare, std::less<Key>>::value)
+        return 1;
+    if (std::is_same<Compare, std::greater<>>::value || std::is_same<Compare, std::greater<Key>>::value)
+        return -1;
+    return 0;
+}
+
+template <typename Key>
+struct RadixTraits {
+    static constexpr bool supported = ((std::is_integral<Key>::value && !std::is_same<Key, bool>::value) ||
+                                       std::is_floating_point<Key>::value) &&
+                                      (sizeof(Key) == 1 || sizeof(Key) == 2 || sizeof(Key) == 4 || sizeof(Key) == 8);
+};
+
+template <size_t N> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { typedef uint8_t type; };
+template <> struct UnsignedOfSize<2> { typedef uint16_t type; };
+template <> struct UnsignedOfSize<4> { typedef uint32_t type; };
+template <> struct UnsignedOfSize<8> { typedef uint64_t type; };
+
+// Map a key to an unsigned integer with the same ordering
+template <typename Key>
+typename UnsignedOfSize<sizeof(Key)>::type toRadix(Key key, bool descending) {
+    typedef typename UnsignedOfSize<sizeof(Key)>::type U;
+    const U signBit = U(1) << (sizeof(U) * 8 - 1);
+    U u;
+    std::memcpy(&u, &key, sizeof(U));
+    if (std::is_floating_point<Key>::value)
+        u = (u & signBit) ? U(~u) : U(u | signBit);  // negatives reversed, positives above them
+    else if (std::is_signed<Key>::value)
+        u ^= signBit;
+    return descending ? U(~u) : u;
+}
+
+// Inverse of toRadix
+template <typename Key, typename U>
+Key fromRadix(U u, bool descending) {
+    const U signBit = U(1) << (sizeof(U) * 8 - 1);
+    if (descending)
+        u = U(~u);
+    if (std::is_floating_point<Key>::value)
+        u = (u & signBit) ? U(u ^ signBit) : U(~u);
+    else if (std::is_signed<Key>::value)
+        u ^= signBit;
+    Key key;
+    std::memcpy(&key, &u, sizeof(U));
+    return key;
+}
+
+// LSD radix sort on byte digits. keys[i] is the radix key of vals[i];
+// vals may be null when the keys are the data. Digits shared by every key
+// are skipped. The sorted result is left in keys (and vals).
+template <typename U, typename T>
+void radixPasses(std::vector<U> &keys, std::vector<U> &keyBuf, std::vector<T> *vals, std::vector<T> *valBuf) {
+    const size_t n = keys.size();
+    const int passes = sizeof(U);
+    std::vector<size_t> counts(passes * 256, 0);
+
+    // All digit histograms in a single read of the keys
+    for (size_t i = 0; i < n; ++i) {
+        U k = keys[i];
+        for (int p = 0; p < passes; ++p)
+            ++counts[p * 256 + ((k >> (8 * p)) & 0xff)];
+    }
+
+    for (int p = 0; p < passes; ++p) {
+        size_t *count = &counts[p * 256];
+        if (count[(keys[0] >> (8 * p)) & 0xff] == n)
+            continue;
+
+        size_t offset = 0;
+        for (int d = 0; d < 256; ++d) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            size_t dst = count[(keys[i] >> (8 * p)) & 0xff]++;
+            keyBuf[dst] = keys[i];
+            if (vals)
+                (*valBuf)[dst] = std::move((*vals)[i]);
+        }
+        keys.swap(keyBuf);
+        if (vals)
+            vals->swap(*valBuf);
+    }
+}
+
+} // namespace detail
+
+// Comparison sort: introsort with ninther pivot, three-way partitioning,
+// insertion sort for small ranges and a heapsort fallback. Built with
+// -fopenmp, large ranges are sorted as OpenMP tasks.
+template <typename RandomIt, typename Compare = std::less<>, typename Proj = Identity>
+void introSort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    if (last - first < 2)
+        return;
+
+    int depthLimit = 0;
+    for (auto n = last - first; n > 1; n >>= 1)
+        depthLimit += 2;
+
+    detail::ProjectedLess<Compare, Proj> less{comp, proj};
+#ifdef _OPENMP
+    #pragma omp parallel if (last - first > detail::PARALLEL_CUTOFF)
+    #pragma omp single nowait
+#endif
+    detail::introSort(first, last, depthLimit, less);
+}
+
+// Stable LSD radix sort by an integral or floating-point projected key.
+// Floats order -0.0 before +0.0 and NaNs at the ends. Extra memory: two
+// key arrays, plus two value arrays for records.
+template <typename RandomIt, typename Proj = Identity>
+void radixSort(RandomIt first, RandomIt last, Proj proj = Proj(), bool descending = false) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    typedef typename std::decay<decltype(std::invoke(proj, *first))>::type Key;
+    typedef typename detail::UnsignedOfSize<sizeof(Key)>::type U;
+    static_assert(detail::RadixTraits<Key>::supported, "radixSort needs an integral or floating-point key");
+
+    const size_t n = last - first;
+    if (n < 2)
+        return;
+
+    std::vector<U> keys(n), keyBuf(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = detail::toRadix<Key>(std::invoke(proj, first[i]), descending);
+
+    if constexpr (std::is_same<Proj, Identity>::value && std::is_same<T, Key>::value) {
+        // Sorting plain numbers: the keys are the data
+        detail::radixPasses<U, T>(keys, keyBuf, nullptr, nullptr);
+        for (size_t i = 0; i < n; ++i)
+            first[i] = detail::fromRadix<Key>(keys[i], descending);
+    } else {
+        std::vector<T> vals(std::make_move_iterator(first), std::make_move_iterator(last));
+        std::vector<T> valBuf(n);
+        detail::radixPasses(keys, keyBuf, &vals, &valBuf);
+        std::move(vals.begin(), vals.end(), first);
+    }
+}
+
+// Sort [first, last) by comp(proj(a), proj(b)), picking the radix path
+// when the key type and comparator allow it
+template <typename RandomIt, typename Compare = std::less<>, typename Proj = Identity>
+void sort(RandomIt first, RandomIt last, Compare comp = Compare(), Proj proj = Proj()) {
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    typedef typename std::decay<decltype(std::invoke(proj, *first))>::type Key;
+
+    constexpr int order = detail::radixOrder<Compare, Key>();
+    if constexpr (order != 0 && detail::RadixTraits<Key>::supported &&
+                  std::is_default_constructible<T>::value && std::is_move_assignable<T>::value) {
+        if (last - first >= detail::RADIX_THRESHOLD) {
+            radixSort(first, last, proj, order < 0);
+            return;
+        }
+    }
+    introSort(first, last, comp, proj);
+}
+
+} // namespace sorting
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+// Compile-time switchable instrumentation: scoped phase timers, named
+// counters and a per-run JSON report.
+//
+//   INSTR_SCOPE("assign");                 time the rest of this block as phase "assign"
+//   INSTR_COUNT("distance_evals", n);      add n to a counter
+//   INSTR_SET_RANK(rank);                  MPI programs: tag the report, one file per rank
+//   INSTR_REPORT("k_mean_profile.json");   write phases and counters
+//
+// Build with -DINSTRUMENT to enable, and also -DINSTRUMENT_PERF to record
+// cycles, instructions and cache misses per phase through perf_event_open
+// (Linux; the calling thread only). If the kernel refuses the counters, one
+// warning is printed per process and those phases record zeros.
+// Without -DINSTRUMENT every macro expands to nothing and its arguments are
+// not evaluated, so keep side effects out of them.
+//
+// Counters are safe to bump from OpenMP threads. Phase times are inclusive
+// (nested scopes are also counted in their parent); put scopes around
+// parallel regions, not inside them.
+
+#ifdef INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#ifdef INSTRUMENT_PERF
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace instrument {
+
+const int NUM_PERF = 3;
+const char* const PERF_NAMES[NUM_PERF] = {"cycles", "instructions", "cache_misses"};
+
+struct Phase {
+    std::atomic<long long> nanoseconds{0};
+    std::atomic<long long> calls{0};
+    std::atomic<long long> perf[NUM_PERF] = {};
+};
+
+struct Registry {
+    std::mutex lock;
+    std::map<std::string, Phase> phases;       // map nodes never move, so
+    std::map<std::string, long long> counters; // call sites can cache references
+    int rank = -1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+inline Phase& phase(const char* name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    return r.phases[name];
+}
+
+inline long long& counter(const char* name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    return r.counters[name];
+}
+
+#ifdef INSTRUMENT_PERF
+// One perf event group per thread: cycles leads, the others follow
+struct PerfGroup {
+    int fd[NUM_PERF] = {-1, -1, -1};
+
+    PerfGroup() {
+        const uint64_t configs[NUM_PERF] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < NUM_PERF; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd[0], 0);
+            if (fd[i] < 0) {
+                // Every thread builds its own group, but one warning is enough
+                static std::once_flag warned;
+                std::call_once(warned, [] {
+                    std::cerr << "instrument: perf_event_open failed, hardware counters disabled" << std::endl;
+                });
+                close();
+                return;
+            }
+        }
+        ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~PerfGroup() { close(); }
+
+    void close() {
+        for (int i = 0; i < NUM_PERF; ++i) {
+            if (fd[i] >= 0) ::close(fd[i]);
+            fd[i] = -1;
+        }
+    }
+
+    void read(long long values[NUM_PERF]) const {
+        uint64_t buf[1 + NUM_PERF] = {};
+        if (fd[0] < 0 || ::read(fd[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+            for (int i = 0; i < NUM_PERF; ++i) values[i] = 0;
+            return;
+        }
+        for (int i = 0; i < NUM_PERF; ++i) values[i] = buf[1 + i];
+    }
+};
+
+inline const PerfGroup& perfGroup() {
+    static thread_local PerfGroup group;
+    return group;
+}
+#endif
+
+// Adds the lifetime of the object to a phase
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Phase& p) : phase_(p) {
+#ifdef INSTRUMENT_PERF
+        perfGroup().read(perfStart_);
+#endif
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        auto end = std::chrono::steady_clock::now();
+        phase_.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count();
+        phase_.calls += 1;
+#ifdef INSTRUMENT_PERF
+        long long perfEnd[NUM_PERF];
+        perfGroup().read(perfEnd);
+        for (int i = 0; i < NUM_PERF; ++i) phase_.perf[i] += perfEnd[i] - perfStart_[i];
+#endif
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Phase& phase_;
+    std::chrono::steady_clock::time_point start_;
+#ifdef INSTRUMENT_PERF
+    long long perfStart_[NUM_PERF];
+#endif
+};
+
+inline void setRank(int rank) { registry().rank = rank; }
+
+// Write the report; MPI ranks get ".rankN" inserted before the extension
+inline void report(std::string path) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+
+    if (r.rank >= 0) {
+        size_t dot = path.rfind('.');
+        std::string suffix = ".rank" + std::to_string(r.rank);
+        path = dot == std::string::npos ? path + suffix : path.substr(0, dot) + suffix + path.substr(dot);
+    }
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "instrument: cannot write " << path << std::endl;
+        return;
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - r.start).count();
+    out << "{\n  \"rank\": " << r.rank << ",\n  \"wall_seconds\": " << wall << ",\n  \"phases\": {";
+    bool first = true;
+    for (const auto& entry : r.phases) {
+        const Phase& p = entry.second;
+        out << (first ? "\n" : ",\n") << "    \"" << entry.first << "\": {\"seconds\": "
+            << p.nanoseconds.load() * 1e-9 << ", \"calls\": " << p.calls.load();
+#ifdef INSTRUMENT_PERF
+        for (int i = 0; i < NUM_PERF; ++i)
+            out << ", \"" << PERF_NAMES[i] << "\": " << p.perf[i].load();
+#endif
+        out << "}";
+        first = false;
+    }
+    out << (first ? "},\n" : "\n  },\n") << "  \"counters\": {";
+    first = true;
+    for (const auto& entry : r.counters) {
+        out << (first ? "\n" : ",\n") << "    \"" << entry.first << "\": " << entry.second;
+        first = false;
+    }
+    out << (first ? "}\n" : "\n  }\n") << "}\n";
+}
+
+} // namespace instrument
+
+#define INSTR_CONCAT2(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT2(a, b)
+
+#define INSTR_SCOPE(name)                                                                      \
+    static instrument::Phase& INSTR_CONCAT(instrPhase_, __LINE__) = instrument::phase(name); \
+    instrument::ScopedTimer INSTR_CONCAT(instrTimer_, __LINE__)(INSTR_CONCAT(instrPhase_, __LINE__))
+
+#define INSTR_COUNT(name, n)                                                  \
+    do {                                                                      \
+        static long long& instrCounter_ = instrument::counter(name);          \
+        __atomic_fetch_add(&instrCounter_, (long long)(n), __ATOMIC_RELAXED); \
+    } while (0)
+
+#define INSTR_SET_RANK(rank) instrument::setRank(rank)
+#define INSTR_REPORT(path) instrument::report(path)
+
+#else
+
+#define INSTR_SCOPE(name) do {} while (0)
+#define INSTR_COUNT(name, n) do {} while (0)
+#define INSTR_SET_RANK(rank) do {} while (0)
+#define INSTR_REPORT(path) do {} while (0)
+
+#endif
+
+#endif
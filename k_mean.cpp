@@ -4,6 +4,8 @@
  #include <cstdlib>
  #include <ctime>
 #include <bits/stdc++.h>
+#include "dataset.hpp"
+#include "instrument.hpp"
 using namespace std;
 
 struct Point {
@@ -22,6 +24,8 @@ double distance(Point a, Centroid b) {
 
 // Function to assign points to the nearest centroid
 void assignClusters(vector<Point>& points, vector<Centroid>& centroids, int k) {
+    INSTR_SCOPE("assign");
+    long long changes = 0;
     for (auto& point : points) {
         double minDist = distance(point, centroids[0]);
         int clusterID = 0;
@@ -33,12 +37,16 @@ void assignClusters(vector<Point>& points, vector<Centroid>& centroids, int k) {
                 clusterID = i;
             }
         }
+        if (point.cluster != clusterID) ++changes;
         point.cluster = clusterID;
     }
+    INSTR_COUNT("distance_evals", (long long)points.size() * k);
+    INSTR_COUNT("label_changes", changes);
 }
 
 // Function to update centroid positions
 void updateCentroids(vector<Point>& points, vector<Centroid>& centroids, int k) {
+    INSTR_SCOPE("update");
     vector<int> counts(k, 0);
     vector<double> sumX(k, 0), sumY(k, 0);
 
@@ -57,7 +65,8 @@ void updateCentroids(vector<Point>& points, vector<Centroid>& centroids, int k)
     }
 }
 
-int main() {
+// Usage: ./k_mean [dataset.bin]  (x and y are the first two columns)
+int main(int argc, char** argv) {
     srand(time(0));
 
     // Example data points
@@ -66,6 +75,20 @@ int main() {
         {1.0, 0.6}, {9.0, 11.0}, {8.0, 2.0}, {10.0, 2.0}, {9.0, 3.0}
     };
 
+    if (argc > 1) {
+        INSTR_SCOPE("io");
+        Dataset ds;
+        if (!ds.open(argv[1])) return 1;
+        if (ds.numColumns() < 2 || ds.numRows() == 0) {
+            cerr << argv[1] << ": need at least two columns and one row" << endl;
+            return 1;
+        }
+        // One sequential pass over each mapped column
+        points.assign(ds.numRows(), Point{0.0, 0.0, 0});
+        ds.forEachValue(0, [&](uint64_t i, double v) { points[i].x = v; });
+        ds.forEachValue(1, [&](uint64_t i, double v) { points[i].y = v; });
+    }
+
     int k = 4; // Number of clusters
     int maxIterations = 100;
     vector<Centroid> centroids(k);
@@ -80,12 +103,23 @@ int main() {
     for (int iter = 0; iter < maxIterations; iter++) {
         assignClusters(points, centroids, k);
         updateCentroids(points, centroids, k);
+        INSTR_COUNT("iterations", 1);
     }
 
-    // Output the final cluster assignments
-    for (auto& point : points) {
-        cout << "Point (" << point.x << ", " << point.y << ") -> Cluster " << point.cluster << endl;
+    // Output the final cluster assignments (cluster sizes for large inputs)
+    if (points.size() <= 50) {
+        for (auto& point : points) {
+            cout << "Point (" << point.x << ", " << point.y << ") -> Cluster " << point.cluster << endl;
+        }
+    } else {
+        vector<int> sizes(k, 0);
+        for (auto& point : points) sizes[point.cluster]++;
+        for (int i = 0; i < k; i++) {
+            cout << "Cluster " << i << ": centroid (" << centroids[i].x << ", " << centroids[i].y
+                 << "), " << sizes[i] << " points" << endl;
+        }
     }
 
+    INSTR_REPORT("k_mean_profile.json");
     return 0;
 }
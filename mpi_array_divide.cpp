@@ -6,8 +6,17 @@
 #include <limits>
 #include <iomanip>  // for setprecision
 
+#include "dataset.hpp"
+#include "instrument.hpp"
+
 using namespace std;
 
+// Usage: mpirun -np 5 ./mpi_array_divide [dataset.bin]
+//
+// Without an argument the master generates the array and sends each slave
+// its part. With a dataset file, each slave maps only its own rows of the
+// first column (float64 or float32) and nothing but results is sent.
+
 struct Result {
     double sum;
     double product;
@@ -15,12 +24,59 @@ struct Result {
     double maxVal;
 };
 
+template <typename T>
+Result summarize(const T* values, uint64_t n) {
+    Result result;
+    result.sum = 0.0;
+    result.product = 1.0;
+    result.minVal = numeric_limits<double>::max();
+    result.maxVal = numeric_limits<double>::lowest();
+
+    for (uint64_t i = 0; i < n; ++i) {
+        double x = values[i];
+        result.sum += x;
+        result.product *= x;
+        if (x < result.minVal) result.minVal = x;
+        if (x > result.maxVal) result.maxVal = x;
+    }
+    return result;
+}
+
+// The slave's rows [begin, end) of column 0, mapped straight from the file
+Result summarizeDataset(const char* path, int part, int parts) {
+    Dataset ds;
+    {
+        INSTR_SCOPE("io");
+        if (!ds.open(path, 0, 0)) MPI_Abort(MPI_COMM_WORLD, 1);   // header only
+        uint64_t begin, end;
+        blockRange(ds.numRows(), parts, part, begin, end);
+        if (!ds.open(path, begin, end) || ds.numColumns() == 0) MPI_Abort(MPI_COMM_WORLD, 1);
+        INSTR_COUNT("bytes_mapped", ds.mappedRows() * columnTypeSize(ds.columnType(0)));
+    }
+
+    // Pages are read on first touch, so page-in is part of this phase
+    INSTR_SCOPE("compute");
+
+    if (ds.columnType(0) == COL_FLOAT64) {
+        ColumnView<double> col = ds.column<double>(0);
+        return summarize(col.data, col.size);
+    }
+    if (ds.columnType(0) == COL_FLOAT32) {
+        ColumnView<float> col = ds.column<float>(0);
+        return summarize(col.data, col.size);
+    }
+    cerr << path << ": column 0 must be float64 or float32" << endl;
+    MPI_Abort(MPI_COMM_WORLD, 1);
+    return Result();
+}
+
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
+    INSTR_SET_RANK(rank);
 
     const int ARRAY_SIZE = 10000;
     const int PARTS = 4;
@@ -31,32 +87,44 @@ int main(int argc, char** argv) {
     MPI_Type_contiguous(4, MPI_DOUBLE, &MPI_RESULT);
     MPI_Type_commit(&MPI_RESULT);
 
+    const char* datasetPath = argc > 1 ? argv[1] : nullptr;
     vector<double> data;
 
     // Master process
     if (rank == 0) {
-        data.resize(ARRAY_SIZE);
+        if (datasetPath == nullptr) {
+            data.resize(ARRAY_SIZE);
 
-        // Fill array with random values
-        srand(time(0));
-        for (int i = 0; i < ARRAY_SIZE; ++i)
-            data[i] = rand() % 100 + 1;
+            // Fill array with random values
+            srand(time(0));
+            for (int i = 0; i < ARRAY_SIZE; ++i)
+                data[i] = rand() % 100 + 1;
+        }
 
         // Start timer
         double start_time = MPI_Wtime();
 
-        // Send 4 parts to ranks 1-4
-        for (int i = 1; i <= PARTS; ++i) {
-            MPI_Send(&data[(i - 1) * PART_SIZE], PART_SIZE, MPI_DOUBLE, i, 0, MPI_COMM_WORLD);
-        }
-
-        // Receive partial results from slaves
         vector<Result> results(PARTS);
-        for (int i = 1; i <= PARTS; ++i) {
-            MPI_Recv(&results[i - 1], 1, MPI_RESULT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        {
+            INSTR_SCOPE("communication");
+
+            // Send 4 parts to ranks 1-4
+            if (datasetPath == nullptr) {
+                for (int i = 1; i <= PARTS; ++i) {
+                    MPI_Send(&data[(i - 1) * PART_SIZE], PART_SIZE, MPI_DOUBLE, i, 0, MPI_COMM_WORLD);
+                }
+                INSTR_COUNT("bytes_sent", (long long)PARTS * PART_SIZE * sizeof(double));
+            }
+
+            // Receive partial results from slaves
+            for (int i = 1; i <= PARTS; ++i) {
+                MPI_Recv(&results[i - 1], 1, MPI_RESULT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+            INSTR_COUNT("bytes_received", PARTS * sizeof(Result));
         }
 
         // Combine results
+        INSTR_SCOPE("compute");
         double total_sum = 0.0;
         double total_product = 1.0;
         double total_min = numeric_limits<double>::max();
@@ -80,25 +148,26 @@ int main(int argc, char** argv) {
         cout << "Total Execution Time: " << (end_time - start_time) << " seconds" << endl;
 
     } else if (rank >= 1 && rank <= PARTS) {
-        vector<double> sub_array(PART_SIZE);
-        MPI_Recv(sub_array.data(), PART_SIZE, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
         Result result;
-        result.sum = 0.0;
-        result.product = 1.0;
-        result.minVal = numeric_limits<double>::max();
-        result.maxVal = numeric_limits<double>::lowest();
-
-        for (auto x : sub_array) {
-            result.sum += x;
-            result.product *= x;
-            if (x < result.minVal) result.minVal = x;
-            if (x > result.maxVal) result.maxVal = x;
+        if (datasetPath != nullptr) {
+            result = summarizeDataset(datasetPath, rank - 1, PARTS);
+        } else {
+            vector<double> sub_array(PART_SIZE);
+            {
+                INSTR_SCOPE("communication");
+                MPI_Recv(sub_array.data(), PART_SIZE, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                INSTR_COUNT("bytes_received", PART_SIZE * sizeof(double));
+            }
+
+            INSTR_SCOPE("compute");
+            result = summarize(sub_array.data(), sub_array.size());
         }
 
         MPI_Send(&result, 1, MPI_RESULT, 0, 0, MPI_COMM_WORLD);
+        INSTR_COUNT("bytes_sent", sizeof(Result));
     }
 
+    INSTR_REPORT("mpi_array_divide_profile.json");
     MPI_Type_free(&MPI_RESULT);
     MPI_Finalize();
     return 0;
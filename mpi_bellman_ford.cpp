@@ -0,0 +1,277 @@
+// Distributed-memory Bellman-Ford over MPI.
+//
+// Build: mpicxx -std=c++17 -O2 mpi_bellman_ford.cpp -o mpi_bellman_ford
+// Run:   mpirun -np 4 ./mpi_bellman_ford edges.txt [source]
+//
+// Vertices are block-partitioned across ranks and each rank keeps only
+// the edges leaving its own vertices. Edge targets owned by other ranks
+// are ghost vertices: a local copy of the best distance this rank has
+// proposed for them. Each round relaxes the active local vertices, then
+// only the ghost distances that improved are sent to their owners with a
+// sparse MPI_Alltoallv. An MPI_Allreduce on a "changed" flag ends the run.
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <cstddef>
+#include <cstdlib>
+
+#include "csr_graph.hpp"
+#include "instrument.hpp"
+
+using namespace std;
+
+const double INF = numeric_limits<double>::infinity();
+
+// A proposed distance for a vertex owned by another rank
+struct Update {
+    double distance;
+    int vertex;
+    int pred;
+};
+
+// Block distribution of the vertex IDs, as in mpi_operations.cpp
+struct Partition {
+    int numVertices, chunk;
+
+    int owner(int v) const { return v / chunk; }
+    int begin(int rank) const { return min(rank * chunk, numVertices); }
+    int end(int rank) const { return min((rank + 1) * chunk, numVertices); }
+};
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    INSTR_SET_RANK(rank);
+
+    if (argc < 2) {
+        if (rank == 0)
+            cerr << "Usage: " << argv[0] << " edges.txt [source]" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    string path = argv[1];
+    int source = argc > 2 ? atoi(argv[2]) : 0;
+
+    // Define MPI datatype for Update struct
+    MPI_Datatype MPI_UPDATE;
+    int blockLengths[3] = {1, 1, 1};
+    MPI_Aint displacements[3] = {offsetof(Update, distance), offsetof(Update, vertex), offsetof(Update, pred)};
+    MPI_Datatype types[3] = {MPI_DOUBLE, MPI_INT, MPI_INT};
+    MPI_Datatype tmp;
+    MPI_Type_create_struct(3, blockLengths, displacements, types, &tmp);
+    MPI_Type_create_resized(tmp, 0, sizeof(Update), &MPI_UPDATE);
+    MPI_Type_free(&tmp);
+    MPI_Type_commit(&MPI_UPDATE);
+
+    double start_time = MPI_Wtime();
+
+    // Pass 1: vertex count (every rank streams the file, nothing is stored)
+    int numVertices = 0;
+    bool ok;
+    {
+        INSTR_SCOPE("io");
+        ok = forEachEdge(path, [&](const Edge& e) {
+            numVertices = max(numVertices, max(e.u, e.v) + 1);
+        });
+    }
+    if (!ok) MPI_Abort(MPI_COMM_WORLD, 1);
+    if (source < 0 || source >= numVertices) {
+        if (rank == 0) cerr << "Source vertex " << source << " out of range" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    Partition part{numVertices, (numVertices + size - 1) / size};
+    int lo = part.begin(rank), hi = part.end(rank);
+    int numLocal = hi - lo;
+
+    // Pass 2: keep only edges leaving local vertices, as a local CSR
+    vector<Edge> localEdges;
+    {
+        INSTR_SCOPE("io");
+        forEachEdge(path, [&](const Edge& e) {
+            if (e.u >= lo && e.u < hi) localEdges.push_back({e.u - lo, e.v, e.w});
+        });
+    }
+    CSRGraph g = buildCSR(numLocal, localEdges);   // targets stay global IDs
+    localEdges.clear();
+    localEdges.shrink_to_fit();
+
+    // Ghost vertices: remote edge targets, each with the best distance sent
+    // so far. edgeGhost[k] is the ghost slot of edge k's target, -1 if local.
+    unordered_map<int, int> ghostIndex;
+    vector<int> ghostVertex;
+    vector<int> edgeGhost(g.numEdges(), -1);
+    for (long long k = 0; k < g.numEdges(); ++k) {
+        int t = g.targets[k];
+        if (t >= lo && t < hi) continue;
+        auto it = ghostIndex.emplace(t, (int)ghostVertex.size());
+        if (it.second) ghostVertex.push_back(t);
+        edgeGhost[k] = it.first->second;
+    }
+    ghostIndex.clear();
+    vector<double> ghostDistance(ghostVertex.size(), INF);
+    vector<int> ghostPred(ghostVertex.size(), -1);
+    vector<char> ghostDirty(ghostVertex.size(), 0);
+
+    vector<double> distance(numLocal, INF);
+    vector<int> predecessor(numLocal, -1);
+    vector<char> active(numLocal, 0), nextActive(numLocal, 0);
+    if (source >= lo && source < hi) {
+        distance[source - lo] = 0;
+        active[source - lo] = 1;
+    }
+
+    double load_time = MPI_Wtime();
+
+    vector<int> sendCounts(size), recvCounts(size), sendDispls(size), recvDispls(size);
+    long long rounds = 0, relaxations = 0, updatesSent = 0;
+    int changed = 1;
+
+    while (changed && rounds < numVertices) {
+        ++rounds;
+        int localChanged = 0;
+        INSTR_COUNT("iterations", 1);
+
+        // 1. Relax edges of active local vertices
+        vector<int> dirtyGhosts;
+        {
+            INSTR_SCOPE("relax");
+            for (int u = 0; u < numLocal; ++u) {
+                if (!active[u]) continue;
+                active[u] = 0;
+                for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.targets[k];
+                    double d = distance[u] + g.weights[k];
+                    int gi = edgeGhost[k];
+                    if (gi < 0) {
+                        if (d < distance[v - lo]) {
+                            distance[v - lo] = d;
+                            predecessor[v - lo] = u + lo;
+                            nextActive[v - lo] = 1;
+                            localChanged = 1;
+                            ++relaxations;
+                        }
+                    } else {
+                        if (d < ghostDistance[gi]) {
+                            ghostDistance[gi] = d;
+                            ghostPred[gi] = u + lo;
+                            if (!ghostDirty[gi]) {
+                                ghostDirty[gi] = 1;
+                                dirtyGhosts.push_back(gi);
+                            }
+                            ++relaxations;
+                        }
+                    }
+                }
+            }
+        }
+
+        // 2. Send only the improved ghost distances to their owners
+        vector<Update> recvBuf;
+        {
+            INSTR_SCOPE("communication");
+            fill(sendCounts.begin(), sendCounts.end(), 0);
+            for (int gi : dirtyGhosts)
+                sendCounts[part.owner(ghostVertex[gi])]++;
+            for (int r = 0, offset = 0; r < size; ++r) {
+                sendDispls[r] = offset;
+                offset += sendCounts[r];
+            }
+            vector<Update> sendBuf(dirtyGhosts.size());
+            vector<int> fillPos(sendDispls);
+            for (int gi : dirtyGhosts) {
+                sendBuf[fillPos[part.owner(ghostVertex[gi])]++] = {ghostDistance[gi], ghostVertex[gi], ghostPred[gi]};
+                ghostDirty[gi] = 0;
+            }
+            updatesSent += dirtyGhosts.size();
+
+            MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+            int recvTotal = 0;
+            for (int r = 0; r < size; ++r) {
+                recvDispls[r] = recvTotal;
+                recvTotal += recvCounts[r];
+            }
+            recvBuf.resize(recvTotal);
+            MPI_Alltoallv(sendBuf.data(), sendCounts.data(), sendDispls.data(), MPI_UPDATE,
+                          recvBuf.data(), recvCounts.data(), recvDispls.data(), MPI_UPDATE, MPI_COMM_WORLD);
+            INSTR_COUNT("bytes_sent", sendBuf.size() * sizeof(Update));
+            INSTR_COUNT("bytes_received", recvBuf.size() * sizeof(Update));
+        }
+
+        // 3. Apply incoming proposals
+        {
+            INSTR_SCOPE("apply");
+            for (const auto& up : recvBuf) {
+                int v = up.vertex - lo;
+                if (up.distance < distance[v]) {
+                    distance[v] = up.distance;
+                    predecessor[v] = up.pred;
+                    nextActive[v] = 1;
+                    localChanged = 1;
+                }
+            }
+            swap(active, nextActive);
+        }
+
+        // 4. Global termination test
+        INSTR_SCOPE("convergence");
+        MPI_Allreduce(&localChanged, &changed, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+    }
+
+    double end_time = MPI_Wtime();
+
+    // Summary
+    long long reached = 0;
+    for (double d : distance)
+        if (d != INF) ++reached;
+    long long totals[3] = {reached, relaxations, updatesSent}, globalTotals[3];
+    MPI_Reduce(totals, globalTotals, 3, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    // Gather the full tables for small graphs only
+    const int PRINT_LIMIT = 50;
+    vector<double> allDistance;
+    vector<int> allPred, counts(size), displs(size);
+    if (numVertices <= PRINT_LIMIT) {
+        for (int r = 0; r < size; ++r) {
+            counts[r] = part.end(r) - part.begin(r);
+            displs[r] = part.begin(r);
+        }
+        if (rank == 0) {
+            allDistance.resize(numVertices);
+            allPred.resize(numVertices);
+        }
+        MPI_Gatherv(distance.data(), numLocal, MPI_DOUBLE, allDistance.data(), counts.data(), displs.data(),
+                    MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Gatherv(predecessor.data(), numLocal, MPI_INT, allPred.data(), counts.data(), displs.data(),
+                    MPI_INT, 0, MPI_COMM_WORLD);
+    }
+
+    if (rank == 0) {
+        cout << "Vertices: " << numVertices << ", ranks: " << size << ", rounds: " << rounds << endl;
+        if (changed)
+            cout << "⚠️ Negative weight cycle detected (still relaxing after |V| rounds)" << endl;
+        cout << "Reached vertices: " << globalTotals[0] << endl;
+        cout << "Relaxations: " << globalTotals[1] << ", ghost updates sent: " << globalTotals[2] << endl;
+        cout << "Load time: " << (load_time - start_time) << " seconds" << endl;
+        cout << "Solve time: " << (end_time - load_time) << " seconds" << endl;
+
+        if (numVertices <= PRINT_LIMIT) {
+            cout << "\n📏 Shortest Distances from " << source << endl;
+            for (int v = 0; v < numVertices; ++v)
+                cout << "  " << source << " → " << v << ": " << allDistance[v]
+                     << " (predecessor " << allPred[v] << ")" << endl;
+        }
+    }
+
+    INSTR_COUNT("relaxations", relaxations);
+    INSTR_REPORT("mpi_bellman_ford_profile.json");
+    MPI_Type_free(&MPI_UPDATE);
+    MPI_Finalize();
+    return 0;
+}
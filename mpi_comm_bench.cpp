@@ -0,0 +1,292 @@
+// Collective vs point-to-point communication microbenchmark.
+//
+// Build: mpicxx -std=c++17 -O2 mpi_comm_bench.cpp -o mpi_comm_bench
+// Run:   mpirun -np 8 ./mpi_comm_bench [max_bytes] > comm.csv
+//
+// The communication patterns of the other MPI programs, each timed both
+// the hand-rolled way and with the MPI collective:
+//
+//   bcast    every rank gets the same array    (MPI_master_slave, mpi_operations)
+//   scatter  every rank gets its own block      (mpi_array_divide)
+//   reduce   partial results combined on rank 0 (all three)
+//
+// Methods: "send" (loop of MPI_Send/MPI_Recv, as in those programs),
+// "isend" (MPI_Isend/MPI_Irecv + MPI_Waitall), "collective" (MPI_Bcast,
+// MPI_Scatter, MPI_Reduce) and "icollective" (MPI_Ibcast, MPI_Iscatter,
+// MPI_Ireduce + MPI_Wait).
+//
+// Message sizes go from 8 B to max_bytes (default 1 GB) in powers of 2;
+// bytes is the amount each non-root rank receives (bcast, scatter) or
+// contributes (reduce), so rank 0 of scatter and reduce holds ranks × bytes.
+// Every pattern is run on the first 2, 4, 8, ... ranks and on all of them.
+//
+// CSV columns:
+//   latency_us     time per operation, slowest rank
+//   bandwidth_MBs  bytes moved to/from the non-root ranks per second
+//   efficiency     latency with 2 ranks / latency with this many ranks;
+//                  1.0 means serving more ranks costs nothing extra
+
+#include <mpi.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+const long long DEFAULT_MAX_BYTES = 1LL << 30;
+const long long BYTES_PER_RUN = 1LL << 26;   // iterations shrink as messages grow
+const int MAX_ITERS = 1000;
+const int MIN_ITERS = 3;
+
+struct Buffers {
+    int count;             // doubles per message
+    vector<double> local;  // this rank's message
+    vector<double> result; // reduce result on rank 0
+    vector<double> all;    // rank 0: one block per rank (scatter source, reduce landing zone)
+    vector<MPI_Request> requests;
+};
+
+// ---- bcast ----
+
+void bcastSend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r)
+            MPI_Send(b.local.data(), b.count, MPI_DOUBLE, r, 0, comm);
+    } else {
+        MPI_Recv(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+    }
+}
+
+void bcastIsend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r)
+            MPI_Isend(b.local.data(), b.count, MPI_DOUBLE, r, 0, comm, &b.requests[r - 1]);
+        MPI_Waitall(size - 1, b.requests.data(), MPI_STATUSES_IGNORE);
+    } else {
+        MPI_Irecv(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm, &b.requests[0]);
+        MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+    }
+}
+
+void bcastCollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Bcast(b.local.data(), b.count, MPI_DOUBLE, 0, comm);
+}
+
+void bcastICollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Ibcast(b.local.data(), b.count, MPI_DOUBLE, 0, comm, &b.requests[0]);
+    MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+}
+
+// ---- scatter ----
+
+void scatterSend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r)
+            MPI_Send(&b.all[(size_t)r * b.count], b.count, MPI_DOUBLE, r, 0, comm);
+    } else {
+        MPI_Recv(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm, MPI_STATUS_IGNORE);
+    }
+}
+
+void scatterIsend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r)
+            MPI_Isend(&b.all[(size_t)r * b.count], b.count, MPI_DOUBLE, r, 0, comm, &b.requests[r - 1]);
+        MPI_Waitall(size - 1, b.requests.data(), MPI_STATUSES_IGNORE);
+    } else {
+        MPI_Irecv(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm, &b.requests[0]);
+        MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+    }
+}
+
+void scatterCollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Scatter(b.all.data(), b.count, MPI_DOUBLE, b.local.data(), b.count, MPI_DOUBLE, 0, comm);
+}
+
+void scatterICollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Iscatter(b.all.data(), b.count, MPI_DOUBLE, b.local.data(), b.count, MPI_DOUBLE, 0, comm,
+                 &b.requests[0]);
+    MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+}
+
+// ---- reduce (element-wise sum) ----
+
+void reduceSend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        copy(b.local.begin(), b.local.end(), b.result.begin());
+        double* tmp = b.all.data();
+        for (int r = 1; r < size; ++r) {
+            MPI_Recv(tmp, b.count, MPI_DOUBLE, r, 0, comm, MPI_STATUS_IGNORE);
+            for (int i = 0; i < b.count; ++i) b.result[i] += tmp[i];
+        }
+    } else {
+        MPI_Send(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm);
+    }
+}
+
+void reduceIsend(MPI_Comm comm, int rank, int size, Buffers& b) {
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r)
+            MPI_Irecv(&b.all[(size_t)r * b.count], b.count, MPI_DOUBLE, r, 0, comm, &b.requests[r - 1]);
+        MPI_Waitall(size - 1, b.requests.data(), MPI_STATUSES_IGNORE);
+        copy(b.local.begin(), b.local.end(), b.result.begin());
+        for (int r = 1; r < size; ++r) {
+            const double* part = &b.all[(size_t)r * b.count];
+            for (int i = 0; i < b.count; ++i) b.result[i] += part[i];
+        }
+    } else {
+        MPI_Isend(b.local.data(), b.count, MPI_DOUBLE, 0, 0, comm, &b.requests[0]);
+        MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+    }
+}
+
+void reduceCollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Reduce(b.local.data(), b.result.data(), b.count, MPI_DOUBLE, MPI_SUM, 0, comm);
+}
+
+void reduceICollective(MPI_Comm comm, int, int, Buffers& b) {
+    MPI_Ireduce(b.local.data(), b.result.data(), b.count, MPI_DOUBLE, MPI_SUM, 0, comm, &b.requests[0]);
+    MPI_Wait(&b.requests[0], MPI_STATUS_IGNORE);
+}
+
+typedef void (*Operation)(MPI_Comm, int, int, Buffers&);
+
+struct Benchmark {
+    const char* pattern;
+    const char* method;
+    Operation run;
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"bcast", "send", bcastSend},
+    {"bcast", "isend", bcastIsend},
+    {"bcast", "collective", bcastCollective},
+    {"bcast", "icollective", bcastICollective},
+    {"scatter", "send", scatterSend},
+    {"scatter", "isend", scatterIsend},
+    {"scatter", "collective", scatterCollective},
+    {"scatter", "icollective", scatterICollective},
+    {"reduce", "send", reduceSend},
+    {"reduce", "isend", reduceIsend},
+    {"reduce", "collective", reduceCollective},
+    {"reduce", "icollective", reduceICollective},
+};
+
+// Known input per pattern, so one warm-up run can be checked
+void fillInput(const string& pattern, int rank, int size, Buffers& b) {
+    if (pattern == "bcast") {
+        fill(b.local.begin(), b.local.end(), rank == 0 ? 42.0 : 0.0);
+    } else if (pattern == "scatter") {
+        fill(b.local.begin(), b.local.end(), -1.0);
+        for (int r = 0; rank == 0 && r < size; ++r)
+            fill(b.all.begin() + (size_t)r * b.count, b.all.begin() + (size_t)(r + 1) * b.count, (double)r);
+    } else {
+        fill(b.local.begin(), b.local.end(), rank + 1.0);
+    }
+}
+
+bool checkOutput(const string& pattern, int rank, int size, const Buffers& b) {
+    const vector<double>& v = pattern == "reduce" ? b.result : b.local;
+    double expected;
+    if (pattern == "bcast") expected = 42.0;
+    else if (pattern == "scatter") expected = rank;
+    else if (rank == 0) expected = size * (size + 1) / 2.0;
+    else return true;
+    if (pattern == "scatter" && rank == 0) return true;   // the root keeps its own block
+    return v.front() == expected && v.back() == expected;
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    int world_rank, world_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    if (world_size < 2) {
+        if (world_rank == 0)
+            cerr << "Please run with at least 2 processes" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+
+    long long maxBytes = argc > 1 ? atoll(argv[1]) : DEFAULT_MAX_BYTES;
+    if (maxBytes < 8 || maxBytes > DEFAULT_MAX_BYTES) {
+        if (world_rank == 0)
+            cerr << "max_bytes must be between 8 and " << DEFAULT_MAX_BYTES << endl;
+        MPI_Finalize();
+        return 1;
+    }
+
+    // 2, 4, 8, ... ranks, then all of them
+    vector<int> rankCounts;
+    for (int p = 2; p < world_size; p *= 2) rankCounts.push_back(p);
+    rankCounts.push_back(world_size);
+
+    if (world_rank == 0) {
+        cout << "pattern,method,ranks,bytes,iterations,latency_us,bandwidth_MBs,efficiency" << endl;
+        cout << fixed << setprecision(3);
+    }
+
+    // Latency with 2 ranks, the baseline for the efficiency column
+    map<string, double> baseline;
+    int failures = 0;
+
+    for (int p : rankCounts) {
+        MPI_Comm comm;
+        MPI_Comm_split(MPI_COMM_WORLD, world_rank < p ? 0 : MPI_UNDEFINED, world_rank, &comm);
+        if (comm == MPI_COMM_NULL) continue;   // not part of this round; rejoin at the next split
+
+        int rank = world_rank;
+        for (long long bytes = 8; bytes <= maxBytes; bytes *= 2) {
+            Buffers b;
+            b.count = bytes / sizeof(double);
+            b.local.resize(b.count);
+            b.result.resize(rank == 0 ? b.count : 0);
+            b.all.resize(rank == 0 ? (size_t)p * b.count : 0);
+            b.requests.resize(p);
+            int iters = (int)max<long long>(MIN_ITERS, min<long long>(MAX_ITERS, BYTES_PER_RUN / bytes));
+
+            for (const Benchmark& bench : BENCHMARKS) {
+                // Warm-up run, checked
+                fillInput(bench.pattern, rank, p, b);
+                bench.run(comm, rank, p, b);
+                if (!checkOutput(bench.pattern, rank, p, b)) {
+                    cerr << "Rank " << rank << ": wrong " << bench.pattern << "/" << bench.method
+                         << " result at " << bytes << " bytes" << endl;
+                    ++failures;
+                }
+
+                MPI_Barrier(comm);
+                double start = MPI_Wtime();
+                for (int i = 0; i < iters; ++i)
+                    bench.run(comm, rank, p, b);
+                double elapsed = MPI_Wtime() - start, slowest;
+                MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+                if (rank == 0) {
+                    double latency = slowest / iters;
+                    string key = string(bench.pattern) + "/" + bench.method + "/" + to_string(bytes);
+                    if (p == 2) baseline[key] = latency;
+                    double bandwidth = (double)bytes * (p - 1) / latency;
+                    cout << bench.pattern << "," << bench.method << "," << p << "," << bytes << ","
+                         << iters << "," << latency * 1e6 << "," << bandwidth / 1e6 << ","
+                         << baseline[key] / latency << endl;
+                }
+            }
+        }
+        MPI_Comm_free(&comm);
+    }
+
+    int totalFailures;
+    MPI_Allreduce(&failures, &totalFailures, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (world_rank == 0 && totalFailures > 0)
+        cerr << totalFailures << " benchmark runs produced wrong results" << endl;
+
+    MPI_Finalize();
+    return totalFailures > 0;
+}
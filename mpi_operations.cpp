@@ -2,17 +2,34 @@
 #include <iostream>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <limits>
+#include <climits>
+
+#include "dataset.hpp"
+#include "instrument.hpp"
 
 using namespace std;
 
+// Usage: mpirun -np 5 ./mpi_operations [shared | dataset.bin]
+//
+// Default: rank 0 sends every slave its own copy of the array.
+// "shared": ranks on the same host share one copy in an MPI shared-memory
+// window (MPI_Win_allocate_shared). Rank 0 fills it in place, and only the
+// leader of each other host receives the data as a message, broadcast
+// over the node leaders.
+// dataset.bin: every slave maps the first (float64) column of a dataset
+// file itself; ranks on one host share the page cache and nothing but
+// the results is sent.
+
 int main(int argc, char** argv) {
     MPI_Init(&argc, &argv);
 
     int world_rank, world_size;
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    INSTR_SET_RANK(world_rank);
 
     if (world_size < 5) {
         if (world_rank == 0)
@@ -21,25 +38,104 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    const int array_size = 100000000;
-    vector<double> data(array_size);
+    bool shared = argc > 1 && strcmp(argv[1], "shared") == 0;
+    const char* datasetPath = argc > 1 && !shared ? argv[1] : nullptr;
+
+    int array_size = 100000000;
+    Dataset dataset;
+    vector<double> private_data;
+    const double* data = nullptr;
+
+    MPI_Comm node_comm = MPI_COMM_NULL, leader_comm = MPI_COMM_NULL;
+    MPI_Win win = MPI_WIN_NULL;
 
     // Start timing before main computation
     double start_time = MPI_Wtime();
 
-    if (world_rank == 0) {
-        srand(time(0));
-        for (int i = 0; i < array_size; ++i) {
-            data[i] = rand() % 100 + 1;
+    if (datasetPath != nullptr) {
+        if (world_rank >= 1 && world_rank <= 4) {
+            INSTR_SCOPE("io");
+            if (!dataset.open(datasetPath)) MPI_Abort(MPI_COMM_WORLD, 1);
+            if (dataset.numColumns() == 0 || dataset.columnType(0) != COL_FLOAT64 || dataset.numRows() > INT_MAX) {
+                cerr << datasetPath << ": need a float64 first column of at most " << INT_MAX << " rows" << endl;
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            data = dataset.column<double>(0).data;
+            array_size = dataset.numRows();
+        }
+    } else if (shared) {
+        // Ranks on this host; ordered by world rank, so world rank 0 is a node leader
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &node_comm);
+        int node_rank;
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_split(MPI_COMM_WORLD, node_rank == 0 ? 0 : MPI_UNDEFINED, world_rank, &leader_comm);
+
+        // The node leader allocates the whole array, the others attach to it
+        double* base;
+        MPI_Aint bytes = node_rank == 0 ? (MPI_Aint)array_size * sizeof(double) : 0;
+        MPI_Win_allocate_shared(bytes, sizeof(double), MPI_INFO_NULL, node_comm, &base, &win);
+        if (node_rank != 0) {
+            MPI_Aint size;
+            int disp_unit;
+            MPI_Win_shared_query(win, 0, &size, &disp_unit, &base);
         }
 
-        for (int rank = 1; rank <= 4; ++rank) {
-            MPI_Send(data.data(), array_size, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD);
+        MPI_Win_fence(0, win);
+        if (world_rank == 0) {
+            INSTR_SCOPE("generate");
+            srand(time(0));
+            for (int i = 0; i < array_size; ++i) {
+                base[i] = rand() % 100 + 1;
+            }
+        }
+        // Inter-node traffic only: one copy per other host
+        {
+            INSTR_SCOPE("communication");
+            if (leader_comm != MPI_COMM_NULL) {
+                MPI_Bcast(base, array_size, MPI_DOUBLE, 0, leader_comm);
+                int leaders;
+                MPI_Comm_size(leader_comm, &leaders);
+                if (world_rank == 0)
+                    INSTR_COUNT("bytes_sent", (long long)(leaders - 1) * array_size * sizeof(double));
+                else
+                    INSTR_COUNT("bytes_received", (long long)array_size * sizeof(double));
+            }
+            MPI_Win_fence(0, win);
         }
 
+        data = base;
+    } else {
+        if (world_rank <= 4) private_data.resize(array_size);
+        if (world_rank == 0) {
+            {
+                INSTR_SCOPE("generate");
+                srand(time(0));
+                for (int i = 0; i < array_size; ++i) {
+                    private_data[i] = rand() % 100 + 1;
+                }
+            }
+
+            INSTR_SCOPE("communication");
+            for (int rank = 1; rank <= 4; ++rank) {
+                MPI_Send(private_data.data(), array_size, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD);
+            }
+            INSTR_COUNT("bytes_sent", 4LL * array_size * sizeof(double));
+        } else if (world_rank >= 1 && world_rank <= 4) {
+            INSTR_SCOPE("communication");
+            MPI_Recv(private_data.data(), array_size, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            INSTR_COUNT("bytes_received", (long long)array_size * sizeof(double));
+        }
+        data = private_data.data();
+    }
+
+    if (world_rank == 0) {
         double results[4];
-        for (int rank = 1; rank <= 4; ++rank) {
-            MPI_Recv(&results[rank - 1], 1, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        {
+            INSTR_SCOPE("communication");
+            for (int rank = 1; rank <= 4; ++rank) {
+                MPI_Recv(&results[rank - 1], 1, MPI_DOUBLE, rank, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+            INSTR_COUNT("bytes_received", 4 * sizeof(double));
         }
 
         cout << "Results from slaves:" << endl;
@@ -50,40 +146,53 @@ int main(int argc, char** argv) {
 
         // End timing after everything is done
         double end_time = MPI_Wtime();
+        cout << "Mode: " << (datasetPath ? "mapped dataset" : shared ? "shared window" : "private copies") << endl;
         cout << "Total execution time (master): " << (end_time - start_time) << " seconds" << endl;
 
     } else if (world_rank >= 1 && world_rank <= 4) {
-        MPI_Recv(data.data(), array_size, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
         double result;
-        switch(world_rank) {
-            case 1:
-                result = 0.0;
-                for (auto x : data) result += x;
-                break;
-            case 2:
-                result = 1.0;
-                for (auto x : data) result *= x;
-                break;
-            case 3:
-                result = numeric_limits<double>::max();
-                for (auto x : data) if (x < result) result = x;
-                break;
-            case 4:
-                result = numeric_limits<double>::lowest();
-                for (auto x : data) if (x > result) result = x;
-                break;
+        {
+            INSTR_SCOPE("compute");
+            switch(world_rank) {
+                case 1:
+                    result = 0.0;
+                    for (int i = 0; i < array_size; ++i) result += data[i];
+                    break;
+                case 2:
+                    result = 1.0;
+                    for (int i = 0; i < array_size; ++i) result *= data[i];
+                    break;
+                case 3:
+                    result = numeric_limits<double>::max();
+                    for (int i = 0; i < array_size; ++i) if (data[i] < result) result = data[i];
+                    break;
+                case 4:
+                    result = numeric_limits<double>::lowest();
+                    for (int i = 0; i < array_size; ++i) if (data[i] > result) result = data[i];
+                    break;
+            }
         }
 
-        MPI_Send(&result, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+        {
+            INSTR_SCOPE("communication");
+            MPI_Send(&result, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD);
+            INSTR_COUNT("bytes_sent", sizeof(double));
+        }
 
         // You can also time each slave's local computation if needed:
-        
+
         double end_time = MPI_Wtime();
         cout << "Execution time (slave " << world_rank << "): " << (end_time - start_time) << " seconds" << endl;
-       
+
+    }
+
+    if (shared) {
+        MPI_Win_free(&win);
+        if (leader_comm != MPI_COMM_NULL) MPI_Comm_free(&leader_comm);
+        MPI_Comm_free(&node_comm);
     }
 
+    INSTR_REPORT("mpi_operations_profile.json");
     MPI_Finalize();
     return 0;
 }
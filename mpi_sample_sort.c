@@ -0,0 +1,259 @@
+// Distributed sample sort over MPI, built on the quickSort kernel.
+//
+// Build: mpicc -O2 -fopenmp -DQUICK_SORT_NO_MAIN mpi_sample_sort.c quick_sort.c -o mpi_sample_sort
+// Run:   mpirun -np 4 ./mpi_sample_sort [total keys] [distinct values]
+//
+// Each rank sorts its shard locally, regular samples pick p-1 splitters
+// (ties between equal keys broken by source rank and position),
+// MPI_Alltoallv sends every key to the rank owning its range and the
+// received sorted runs are combined with a k-way merge. Rank r ends up
+// holding the r-th slice of the globally sorted sequence.
+//
+// Counts and displacements are int, as MPI_Alltoallv requires, so every
+// shard and every rank's received slice must stay below 2^31 keys; larger
+// runs are rejected with an error instead of overflowing. Use more ranks
+// to sort more keys.
+
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "quick_sort.h"
+
+#define DEFAULT_KEYS 10000000LL  // 1e7 keys in total
+
+// First index in arr[0..n) whose key is not less than key (orEqual = 0)
+// or greater than key (orEqual = 1)
+static int searchBound(const int arr[], int n, int key, int orEqual) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (arr[mid] < key || (orEqual && arr[mid] == key)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// A sample or splitter: the key plus where it sits, so that keys compare
+// as (key, rank, index) and every key is distinct. Equal keys are then
+// cut between ranks like any others instead of all landing on one rank.
+typedef struct {
+    int key;
+    int rank;
+    int index;   // position in the sorted shard
+} Sample;
+
+static int compareSamples(const void *a, const void *b) {
+    const Sample *x = (const Sample *)a, *y = (const Sample *)b;
+    if (x->key != y->key) return (x->key > y->key) - (x->key < y->key);
+    if (x->rank != y->rank) return (x->rank > y->rank) - (x->rank < y->rank);
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Number of keys of this rank's sorted shard that are <= s in (key, rank, index) order
+static int countNotAfter(const int arr[], int n, int rank, const Sample *s) {
+    if (rank < s->rank) return searchBound(arr, n, s->key, 1);
+    if (rank > s->rank) return searchBound(arr, n, s->key, 0);
+    return s->index + 1;
+}
+
+// Min-heap entry for the k-way merge: current key and the run it came from
+typedef struct {
+    int key;
+    int run;
+} HeapEntry;
+
+static void siftDownHeap(HeapEntry heap[], int root, int n) {
+    while (2 * root + 1 < n) {
+        int child = 2 * root + 1;
+        if (child + 1 < n && heap[child + 1].key < heap[child].key) child++;
+        if (heap[root].key <= heap[child].key) return;
+        HeapEntry temp = heap[root];
+        heap[root] = heap[child];
+        heap[child] = temp;
+        root = child;
+    }
+}
+
+// Merge numRuns sorted runs laid out back to back in in[] (run r starts at
+// displs[r] and holds counts[r] keys) into out[]
+static void mergeRuns(const int in[], const int counts[], const int displs[], int numRuns, int out[]) {
+    HeapEntry *heap = (HeapEntry *)malloc(numRuns * sizeof(HeapEntry));
+    int *pos = (int *)malloc(numRuns * sizeof(int));
+    int n = 0;
+
+    for (int r = 0; r < numRuns; r++) {
+        pos[r] = 0;
+        if (counts[r] > 0) {
+            heap[n].key = in[displs[r]];
+            heap[n].run = r;
+            n++;
+        }
+    }
+    for (int i = n / 2 - 1; i >= 0; i--)
+        siftDownHeap(heap, i, n);
+
+    long long k = 0;
+    while (n > 0) {
+        int r = heap[0].run;
+        out[k++] = heap[0].key;
+        if (++pos[r] < counts[r]) {
+            heap[0].key = in[displs[r] + pos[r]];
+        } else {
+            heap[0] = heap[--n];
+        }
+        siftDownHeap(heap, 0, n);
+    }
+
+    free(heap);
+    free(pos);
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    int world_rank, world_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    long long total = argc > 1 ? atoll(argv[1]) : DEFAULT_KEYS;
+    int distinct = argc > 2 ? atoi(argv[2]) : 0;   // 0: full rand() range
+
+    // Block distribution of the keys, as in mpi_operations.cpp
+    long long base = total / world_size;
+    long long largestShard = base + (total % world_size ? 1 : 0);
+    if (total < 0 || largestShard > INT_MAX) {
+        if (world_rank == 0 && total < 0)
+            fprintf(stderr, "The number of keys must not be negative\n");
+        else if (world_rank == 0)
+            fprintf(stderr, "Cannot sort %lld keys on %d ranks: shards are limited to %d keys\n",
+                    total, world_size, INT_MAX);
+        MPI_Finalize();
+        return 1;
+    }
+    int n = (int)(base + (world_rank < total % world_size ? 1 : 0));
+
+    int *local = (int *)malloc((n > 0 ? n : 1) * sizeof(int));
+    if (local == NULL) {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Generate random values, seeded differently for each rank
+    unsigned int seed = 12345u + 7919u * world_rank;
+    for (int i = 0; i < n; i++)
+        local[i] = distinct > 0 ? rand_r(&seed) % distinct : rand_r(&seed);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start_time = MPI_Wtime();
+
+    // 1. Local sort
+    quickSort(local, 0, n - 1);
+
+    // 2. Regular sampling: p evenly spaced keys from every rank; an empty
+    // shard sends samples that sort after every real key
+    int p = world_size;
+    Sample *samples = (Sample *)malloc(p * sizeof(Sample));
+    for (int i = 0; i < p; i++) {
+        int index = (int)((long long)i * n / p);
+        samples[i].key = n > 0 ? local[index] : INT_MAX;
+        samples[i].rank = n > 0 ? world_rank : INT_MAX;
+        samples[i].index = index;
+    }
+
+    Sample *allSamples = (Sample *)malloc(p * p * sizeof(Sample));
+    MPI_Allgather(samples, 3 * p, MPI_INT, allSamples, 3 * p, MPI_INT, MPI_COMM_WORLD);
+
+    // Every rank sorts the p*p samples and picks the same p-1 splitters
+    qsort(allSamples, p * p, sizeof(Sample), compareSamples);
+    Sample *splitters = (Sample *)malloc(p * sizeof(Sample));
+    for (int i = 1; i < p; i++)
+        splitters[i - 1] = allSamples[i * p + p / 2 - 1];
+
+    // 3. Bucket boundaries: keys in (splitters[r-1], splitters[r]] go to rank r
+    int *sendCounts = (int *)malloc(p * sizeof(int));
+    int *sendDispls = (int *)malloc(p * sizeof(int));
+    int prev = 0;
+    for (int r = 0; r < p; r++) {
+        int end = r < p - 1 ? countNotAfter(local, n, world_rank, &splitters[r]) : n;
+        if (end < prev) end = prev;
+        sendDispls[r] = prev;
+        sendCounts[r] = end - prev;
+        prev = end;
+    }
+
+    // 4. Exchange counts, then the keys themselves
+    int *recvCounts = (int *)malloc(p * sizeof(int));
+    int *recvDispls = (int *)malloc(p * sizeof(int));
+    MPI_Alltoall(sendCounts, 1, MPI_INT, recvCounts, 1, MPI_INT, MPI_COMM_WORLD);
+
+    long long recvTotal = 0;
+    for (int r = 0; r < p; r++) {
+        recvDispls[r] = (int)recvTotal;
+        recvTotal += recvCounts[r];
+    }
+    // Skewed keys can send one rank more than its share
+    if (recvTotal > INT_MAX) {
+        fprintf(stderr, "Rank %d would receive %lld keys, more than the %d an int displacement allows\n",
+                world_rank, recvTotal, INT_MAX);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int *received = (int *)malloc((recvTotal > 0 ? recvTotal : 1) * sizeof(int));
+    int *sorted = (int *)malloc((recvTotal > 0 ? recvTotal : 1) * sizeof(int));
+    if (received == NULL || sorted == NULL) {
+        fprintf(stderr, "Memory allocation failed on rank %d\n", world_rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Alltoallv(local, sendCounts, sendDispls, MPI_INT,
+                  received, recvCounts, recvDispls, MPI_INT, MPI_COMM_WORLD);
+
+    // 5. K-way merge of the p sorted runs
+    mergeRuns(received, recvCounts, recvDispls, p, sorted);
+
+    double end_time = MPI_Wtime();
+
+    // Check: sorted locally, ordered across rank boundaries, nothing lost
+    int ok = 1;
+    for (long long i = 1; i < recvTotal; i++)
+        if (sorted[i - 1] > sorted[i]) ok = 0;
+
+    int myMin = recvTotal > 0 ? sorted[0] : INT_MAX;
+    int myMax = recvTotal > 0 ? sorted[recvTotal - 1] : INT_MIN;
+    int prevMax = INT_MIN;
+    MPI_Sendrecv(&myMax, 1, MPI_INT, world_rank + 1 < p ? world_rank + 1 : MPI_PROC_NULL, 0,
+                 &prevMax, 1, MPI_INT, world_rank > 0 ? world_rank - 1 : MPI_PROC_NULL, 0,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    // An empty rank passes on nothing useful, so only compare when we hold keys
+    if (recvTotal > 0 && prevMax > myMin) ok = 0;
+
+    int allOk;
+    long long sortedTotal;
+    MPI_Reduce(&ok, &allOk, 1, MPI_INT, MPI_LAND, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&recvTotal, &sortedTotal, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    double elapsed = end_time - start_time, maxElapsed;
+    MPI_Reduce(&elapsed, &maxElapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    printf("Rank %d holds %lld keys\n", world_rank, recvTotal);
+    if (world_rank == 0) {
+        printf("Sorted %lld keys on %d ranks in %f seconds (%s)\n",
+               sortedTotal, p, maxElapsed,
+               allOk && sortedTotal == total ? "verified" : "FAILED");
+    }
+
+    free(local);
+    free(samples);
+    free(allSamples);
+    free(splitters);
+    free(sendCounts);
+    free(sendDispls);
+    free(recvCounts);
+    free(recvDispls);
+    free(received);
+    free(sorted);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -1,57 +1,374 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "quick_sort.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #define SIZE 100000  // 1e5 elements
 
-void quickSort(int arr[], int low, int high);
-int partition(int arr[], int low, int high);
+#define INSERTION_THRESHOLD 16   // ranges this small go to insertion sort
+#define NINTHER_THRESHOLD 128    // ranges larger than this use a ninther pivot
+#define PARALLEL_CUTOFF 10000    // ranges larger than this are sorted as tasks
+
+// Block width of the two-way partition: one SIMD register of 32-bit keys.
+// The scalar block partition uses the same width so both modes produce
+// exactly the same array layout.
+#if defined(__AVX512F__)
+#define BLOCK_WIDTH 16
+#else
+#define BLOCK_WIDTH 8
+#endif
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+int partitionMode = PARTITION_SIMD;
+#else
+int partitionMode = PARTITION_BLOCK;
+#endif
+
+static void swap(int *a, int *b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+#if !defined(__AVX512F__) && defined(__AVX2__)
+// Lane permutation per 8-bit comparison mask: set lanes first, in order
+static int permTable[256][8];
+
+static void initPermTable(void) {
+    for (int m = 0; m < 256; m++) {
+        int k = 0;
+        for (int i = 0; i < 8; i++) if (m & (1 << i)) permTable[m][k++] = i;
+        for (int i = 0; i < 8; i++) if (!(m & (1 << i))) permTable[m][k++] = i;
+    }
+}
+#endif
 
-// Quick Sort function
+// Quick Sort function: introsort with three-way partitioning.
+// Built with -fopenmp, large ranges are sorted as tasks on the OpenMP pool.
 void quickSort(int arr[], int low, int high) {
-    if (low < high) {
-        int pi = partition(arr, low, high);
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
+    if (low >= high) return;
+
+#if !defined(__AVX512F__) && defined(__AVX2__)
+    static int permTableReady = 0;
+    if (!permTableReady) {
+        initPermTable();
+        permTableReady = 1;
     }
+#endif
+
+    // Recursion depth limit 2*log2(n), after which heapsort takes over
+    int depthLimit = 0;
+    for (int n = high - low + 1; n > 1; n >>= 1)
+        depthLimit += 2;
+
+#ifdef _OPENMP
+    #pragma omp parallel if (high - low + 1 > PARALLEL_CUTOFF)
+    #pragma omp single nowait
+#endif
+    introSort(arr, low, high, depthLimit);
 }
 
-// Partition function
-int partition(int arr[], int low, int high) {
-    int pivot = arr[high];
-    int i = low - 1;
+// Recurse on the smaller side and loop on the larger one, so the stack
+// stays O(log n) even before the depth limit kicks in
+void introSort(int arr[], int low, int high, int depthLimit) {
+    while (high - low + 1 > INSERTION_THRESHOLD) {
+        if (depthLimit-- == 0) {
+            heapSort(arr, low, high);
+            return;
+        }
+
+        int p = choosePivot(arr, low, high);
+        int pivot = arr[p];
+        int lt, gt;
 
-    for (int j = low; j < high; j++) {
-        if (arr[j] < pivot) {
+        if (partitionMode == PARTITION_BRANCHY) {
+            partition(arr, low, high, pivot, &lt, &gt);
+        } else {
+            swap(&arr[p], &arr[high]);
+            lt = blockPartition(arr, low, high - 1, pivot);
+            swap(&arr[lt], &arr[high]);
+            gt = lt;
+            // Nothing below the pivot: a median of distinct samples is never
+            // the minimum, so the range holds copies of it. Gather them with
+            // the three-way partition, or equal runs would recurse one key
+            // at a time.
+            if (lt == low)
+                partition(arr, low, high, pivot, &lt, &gt);
+        }
+
+        // [low, lt-1] < pivot, [lt, gt] == pivot, [gt+1, high] > pivot
+        int sLow, sHigh;
+        if (lt - low < high - gt) {
+            sLow = low; sHigh = lt - 1;
+            low = gt + 1;
+        } else {
+            sLow = gt + 1; sHigh = high;
+            high = lt - 1;
+        }
+
+        if (sHigh - sLow + 1 > PARALLEL_CUTOFF) {
+#ifdef _OPENMP
+            #pragma omp task firstprivate(arr, sLow, sHigh, depthLimit)
+#endif
+            introSort(arr, sLow, sHigh, depthLimit);
+        } else {
+            introSort(arr, sLow, sHigh, depthLimit);
+        }
+    }
+    insertionSort(arr, low, high);
+}
+
+// Three-way (Dutch flag) partition around pivot, so runs of equal keys
+// are finished in one pass instead of degrading to O(n^2)
+void partition(int arr[], int low, int high, int pivot, int *lt, int *gt) {
+    int l = low, i = low, g = high;
+    while (i <= g) {
+        if (arr[i] < pivot)
+            swap(&arr[l++], &arr[i++]);
+        else if (arr[i] > pivot)
+            swap(&arr[i], &arr[g--]);
+        else
             i++;
-            // Swap arr[i] and arr[j]
-            int temp = arr[i];
-            arr[i] = arr[j];
-            arr[j] = temp;
+    }
+    *lt = l;
+    *gt = g;
+}
+
+// Partition one block of BLOCK_WIDTH keys read from v: keys < pivot are
+// written at arr[*writeL], the rest end at arr[*writeR - 1]. Both stores
+// write a full block; the caller guarantees that much free space per side.
+static void partitionBlock(int arr[], const int v[], int pivot, int *writeL, int *writeR) {
+#if defined(__AVX512F__)
+    if (partitionMode == PARTITION_SIMD) {
+        __m512i keys = _mm512_loadu_si512(v);
+        __mmask16 less = _mm512_cmplt_epi32_mask(keys, _mm512_set1_epi32(pivot));
+        int countL = __builtin_popcount(less);
+        _mm512_mask_compressstoreu_epi32(arr + *writeL, less, keys);
+        _mm512_mask_compressstoreu_epi32(arr + *writeR - (BLOCK_WIDTH - countL), (__mmask16)~less, keys);
+        *writeL += countL;
+        *writeR -= BLOCK_WIDTH - countL;
+        return;
+    }
+#elif defined(__AVX2__)
+    if (partitionMode == PARTITION_SIMD) {
+        // AVX2 has no compress-store: permute lesser lanes to the front via
+        // a table indexed by the comparison mask, then store twice
+        __m256i keys = _mm256_loadu_si256((const __m256i *)v);
+        __m256i less = _mm256_cmpgt_epi32(_mm256_set1_epi32(pivot), keys);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(less));
+        int countL = __builtin_popcount(mask);
+        __m256i perm = _mm256_permutevar8x32_epi32(keys, _mm256_loadu_si256((const __m256i *)permTable[mask]));
+        _mm256_storeu_si256((__m256i *)(arr + *writeL), perm);
+        _mm256_storeu_si256((__m256i *)(arr + *writeR - BLOCK_WIDTH), perm);
+        *writeL += countL;
+        *writeR -= BLOCK_WIDTH - countL;
+        return;
+    }
+#endif
+    // Scalar fallback: same lane order as the SIMD paths, no data-dependent branches
+    int perm[BLOCK_WIDTH];
+    int countL = 0, seenL = 0;
+    for (int i = 0; i < BLOCK_WIDTH; i++)
+        countL += v[i] < pivot;
+    for (int i = 0; i < BLOCK_WIDTH; i++) {
+        int isLess = v[i] < pivot;
+        perm[isLess * seenL + (1 - isLess) * (countL + i - seenL)] = v[i];
+        seenL += isLess;
+    }
+    memcpy(arr + *writeL, perm, sizeof(perm));
+    memcpy(arr + *writeR - BLOCK_WIDTH, perm, sizeof(perm));
+    *writeL += countL;
+    *writeR -= BLOCK_WIDTH - countL;
+}
+
+// Branchless two-way partition of arr[low..high]: keys < pivot move to
+// the front. Returns the index of the first key >= pivot.
+//
+// The first and last block are set aside to open free space at both ends;
+// each step then reads a block from the side with less free space and
+// writes its lesser keys left and the rest right.
+int blockPartition(int arr[], int low, int high, int pivot) {
+    int n = high - low + 1;
+    if (n < 2 * BLOCK_WIDTH) {
+        // Branchless Lomuto: always swap, advance by the comparison
+        int i = low;
+        for (int j = low; j <= high; j++) {
+            int x = arr[j];
+            arr[j] = arr[i];
+            arr[i] = x;
+            i += x < pivot;
         }
+        return i;
     }
 
-    // Swap arr[i+1] and pivot
-    int temp = arr[i + 1];
-    arr[i + 1] = arr[high];
-    arr[high] = temp;
+    int first[BLOCK_WIDTH], last[BLOCK_WIDTH], block[BLOCK_WIDTH];
+    memcpy(first, arr + low, sizeof(first));
+    memcpy(last, arr + high + 1 - BLOCK_WIDTH, sizeof(last));
 
-    return i + 1;
+    int readL = low + BLOCK_WIDTH, readR = high + 1 - BLOCK_WIDTH;
+    int writeL = low, writeR = high + 1;
+    while (readR - readL >= BLOCK_WIDTH) {
+        if (readL - writeL <= writeR - readR) {
+            memcpy(block, arr + readL, sizeof(block));
+            readL += BLOCK_WIDTH;
+        } else {
+            readR -= BLOCK_WIDTH;
+            memcpy(block, arr + readR, sizeof(block));
+        }
+        partitionBlock(arr, block, pivot, &writeL, &writeR);
+    }
+
+    // Leftover keys plus the two saved blocks fill the remaining gap
+    int rest = readR - readL;
+    int tail[3 * BLOCK_WIDTH];
+    memcpy(tail, arr + readL, rest * sizeof(int));
+    memcpy(tail + rest, first, sizeof(first));
+    memcpy(tail + rest + BLOCK_WIDTH, last, sizeof(last));
+    for (int i = 0; i < rest + 2 * BLOCK_WIDTH; i++) {
+        int x = tail[i];
+        int isLess = x < pivot;
+        arr[writeL] = x;
+        arr[writeR - 1] = x;
+        writeL += isLess;
+        writeR -= 1 - isLess;
+    }
+    return writeL;
+}
+
+// Index of the median of arr[a], arr[b], arr[c]
+static int medianOfThree(int arr[], int a, int b, int c) {
+    if (arr[a] < arr[b]) {
+        if (arr[b] < arr[c]) return b;
+        return arr[a] < arr[c] ? c : a;
+    }
+    if (arr[a] < arr[c]) return a;
+    return arr[b] < arr[c] ? c : b;
+}
+
+// Median-of-3 pivot, or Tukey's ninther for large ranges
+int choosePivot(int arr[], int low, int high) {
+    int n = high - low + 1;
+    int mid = low + n / 2;
+    if (n > NINTHER_THRESHOLD) {
+        int s = n / 8;
+        int a = medianOfThree(arr, low, low + s, low + 2 * s);
+        int b = medianOfThree(arr, mid - s, mid, mid + s);
+        int c = medianOfThree(arr, high - 2 * s, high - s, high);
+        return medianOfThree(arr, a, b, c);
+    }
+    return medianOfThree(arr, low, mid, high);
+}
+
+void insertionSort(int arr[], int low, int high) {
+    for (int i = low + 1; i <= high; i++) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= low && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+static void siftDown(int a[], int root, int n) {
+    while (2 * root + 1 < n) {
+        int child = 2 * root + 1;
+        if (child + 1 < n && a[child] < a[child + 1]) child++;
+        if (a[root] >= a[child]) return;
+        swap(&a[root], &a[child]);
+        root = child;
+    }
+}
+
+// Heapsort fallback: guaranteed O(n log n) when partitioning goes bad
+void heapSort(int arr[], int low, int high) {
+    int *a = arr + low;
+    int n = high - low + 1;
+    for (int i = n / 2 - 1; i >= 0; i--)
+        siftDown(a, i, n);
+    for (int i = n - 1; i > 0; i--) {
+        swap(&a[0], &a[i]);
+        siftDown(a, 0, i);
+    }
+}
+
+// Standalone test driver, left out when the kernel is linked elsewhere
+#ifndef QUICK_SORT_NO_MAIN
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static double elapsedSeconds(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
 }
 
 int main() {
+    int *input = (int *)malloc(SIZE * sizeof(int));
     int *arr = (int *)malloc(SIZE * sizeof(int));
-    if (arr == NULL) {
+    int *ref = (int *)malloc(SIZE * sizeof(int));
+    if (input == NULL || arr == NULL || ref == NULL) {
         printf("Memory allocation failed!\n");
         return 1;
     }
 
     // Generate random values
     for (int i = 0; i < SIZE; i++) {
-        arr[i] = rand();
+        input[i] = rand();
+        ref[i] = input[i];
     }
 
-    // Sort the array
-    quickSort(arr, 0, SIZE - 1);
+    // Same input through the C library sort for reference
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    qsort(ref, SIZE, sizeof(int), compareInts);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("qsort: %.6f s\n", elapsedSeconds(start, end));
+
+    // Sort the array with each partition mode
+    const char *modeNames[] = {"branchy", "block", "simd"};
+#if defined(__AVX512F__) || defined(__AVX2__)
+    int numModes = 3;
+#else
+    int numModes = 2;
+#endif
+    for (int mode = 0; mode < numModes; mode++) {
+        partitionMode = mode;
+        memcpy(arr, input, SIZE * sizeof(int));
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        quickSort(arr, 0, SIZE - 1);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        for (int i = 0; i < SIZE; i++) {
+            if (arr[i] != ref[i]) {
+                printf("Mismatch at index %d (%s)\n", i, modeNames[mode]);
+                return 1;
+            }
+        }
+        printf("quickSort (%s): %.6f s\n", modeNames[mode], elapsedSeconds(start, end));
+    }
+
+    // The SIMD partition must leave exactly the same layout as the scalar one
+    if (numModes == 3) {
+        int pivot = input[SIZE / 2];
+        memcpy(arr, input, SIZE * sizeof(int));
+        memcpy(ref, input, SIZE * sizeof(int));
+        partitionMode = PARTITION_BLOCK;
+        int splitBlock = blockPartition(arr, 0, SIZE - 1, pivot);
+        partitionMode = PARTITION_SIMD;
+        int splitSimd = blockPartition(ref, 0, SIZE - 1, pivot);
+        if (splitBlock != splitSimd || memcmp(arr, ref, SIZE * sizeof(int)) != 0) {
+            printf("SIMD and scalar partitions differ!\n");
+            return 1;
+        }
+    }
 
     // Print the first 100 sorted elements for checking
     // printf("First 100 elements of sorted array:\n");
@@ -60,6 +377,9 @@ int main() {
     // }
     // printf("\n");
 
+    free(input);
     free(arr);
+    free(ref);
     return 0;
 }
+#endif
@@ -1,51 +1,225 @@
 #include <bits/stdc++.h>
+#include "generic_sort.hpp"
 using namespace std;
 
-int partition(vector<int> &arr, int low, int high)
+// Indices are ptrdiff_t so arrays beyond 2^31 elements work.
+// generic_sort.hpp has the templated version of this sort.
+const ptrdiff_t INSERTION_THRESHOLD = 16;  // ranges this small go to insertion sort
+const ptrdiff_t NINTHER_THRESHOLD = 128;   // ranges larger than this use a ninther pivot
+const ptrdiff_t PARALLEL_CUTOFF = 10000;   // ranges larger than this are sorted as tasks
+
+// Three-way (Dutch flag) partition: afterwards arr[low..lt-1] < pivot,
+// arr[lt..gt] == pivot and arr[gt+1..high] > pivot
+void partition(vector<int> &arr, ptrdiff_t low, ptrdiff_t high, int pivot, ptrdiff_t &lt, ptrdiff_t &gt)
 {
+    lt = low;
+    gt = high;
+    ptrdiff_t i = low;
+
+    // Equal keys collect in the middle, so all-equal input
+    // finishes in one pass instead of degrading to O(n^2)
+    while (i <= gt)
+    {
+        if (arr[i] < pivot)
+            swap(arr[lt++], arr[i++]);
+        else if (arr[i] > pivot)
+            swap(arr[i], arr[gt--]);
+        else
+            i++;
+    }
+}
 
-    // Choose the pivot
-    int pivot = arr[high];
+// Index of the median of arr[a], arr[b], arr[c]
+ptrdiff_t medianOfThree(const vector<int> &arr, ptrdiff_t a, ptrdiff_t b, ptrdiff_t c)
+{
+    if (arr[a] < arr[b])
+    {
+        if (arr[b] < arr[c])
+            return b;
+        return arr[a] < arr[c] ? c : a;
+    }
+    if (arr[a] < arr[c])
+        return a;
+    return arr[b] < arr[c] ? c : b;
+}
 
-    // Index of smaller element and indicates
-    // the right position of pivot found so far
-    int i = low - 1;
+// Median-of-3 pivot, or Tukey's ninther for large ranges. Unlike the
+// last element, this stays near the middle on sorted input.
+ptrdiff_t choosePivot(const vector<int> &arr, ptrdiff_t low, ptrdiff_t high)
+{
+    ptrdiff_t n = high - low + 1;
+    ptrdiff_t mid = low + n / 2;
+    if (n > NINTHER_THRESHOLD)
+    {
+        ptrdiff_t s = n / 8;
+        ptrdiff_t a = medianOfThree(arr, low, low + s, low + 2 * s);
+        ptrdiff_t b = medianOfThree(arr, mid - s, mid, mid + s);
+        ptrdiff_t c = medianOfThree(arr, high - 2 * s, high - s, high);
+        return medianOfThree(arr, a, b, c);
+    }
+    return medianOfThree(arr, low, mid, high);
+}
 
-    // Traverse arr[low..high] and move all smaller
-    // elements on left side. Elements from low to
-    // i are smaller after every iteration
-    for (int j = low; j <= high - 1; j++)
+void insertionSort(vector<int> &arr, ptrdiff_t low, ptrdiff_t high)
+{
+    for (ptrdiff_t i = low + 1; i <= high; i++)
     {
-        if (arr[j] < pivot)
+        int key = arr[i];
+        ptrdiff_t j = i - 1;
+        while (j >= low && arr[j] > key)
         {
-            i++;
-            swap(arr[i], arr[j]);
+            arr[j + 1] = arr[j];
+            j--;
         }
+        arr[j + 1] = key;
     }
+}
+
+// Heapsort fallback: guaranteed O(n log n) when partitioning goes bad
+void heapSort(vector<int> &arr, ptrdiff_t low, ptrdiff_t high)
+{
+    make_heap(arr.begin() + low, arr.begin() + high + 1);
+    sort_heap(arr.begin() + low, arr.begin() + high + 1);
+}
+
+// Recurse on the smaller side and loop on the larger one, so the
+// stack stays O(log n) even before the depth limit kicks in
+void introSort(vector<int> &arr, ptrdiff_t low, ptrdiff_t high, int depthLimit)
+{
+    while (high - low + 1 > INSERTION_THRESHOLD)
+    {
+        if (depthLimit-- == 0)
+        {
+            heapSort(arr, low, high);
+            return;
+        }
+
+        ptrdiff_t lt, gt;
+        partition(arr, low, high, arr[choosePivot(arr, low, high)], lt, gt);
+
+        ptrdiff_t sLow, sHigh;
+        if (lt - low < high - gt)
+        {
+            sLow = low;
+            sHigh = lt - 1;
+            low = gt + 1;
+        }
+        else
+        {
+            sLow = gt + 1;
+            sHigh = high;
+            high = lt - 1;
+        }
 
-    // Move pivot after smaller elements and
-    // return its position
-    swap(arr[i + 1], arr[high]);
-    return i + 1;
+        // Large sub-ranges become tasks on the OpenMP thread pool
+        if (sHigh - sLow + 1 > PARALLEL_CUTOFF)
+        {
+#ifdef _OPENMP
+            #pragma omp task firstprivate(sLow, sHigh, depthLimit) shared(arr)
+#endif
+            introSort(arr, sLow, sHigh, depthLimit);
+        }
+        else
+        {
+            introSort(arr, sLow, sHigh, depthLimit);
+        }
+    }
+    insertionSort(arr, low, high);
 }
 
 // The QuickSort function implementation
-void quickSort(vector<int> &arr, int low, int high)
+void quickSort(vector<int> &arr, ptrdiff_t low, ptrdiff_t high)
+{
+    if (low >= high)
+        return;
+
+    // Recursion depth limit 2*log2(n), after which heapsort takes over
+    int depthLimit = 0;
+    for (ptrdiff_t n = high - low + 1; n > 1; n >>= 1)
+        depthLimit += 2;
+
+#ifdef _OPENMP
+    #pragma omp parallel if (high - low + 1 > PARALLEL_CUTOFF)
+    #pragma omp single nowait
+#endif
+    introSort(arr, low, high, depthLimit);
+}
+
+int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Fill arr with one of the benchmark input patterns
+void fillPattern(vector<int> &arr, const string &pattern, mt19937 &gen)
+{
+    if (pattern == "equal")
+    {
+        fill(arr.begin(), arr.end(), 42);
+        return;
+    }
+    for (auto &x : arr)
+        x = gen() & 0x7fffffff;
+    if (pattern == "random")
+        return;
+
+    sort(arr.begin(), arr.end());
+    if (pattern == "nearly_sorted")
+    {
+        // Swap 1% of the elements at random
+        uniform_int_distribution<size_t> pick(0, arr.size() - 1);
+        for (size_t i = 0; i < arr.size() / 100; i++)
+            swap(arr[pick(gen)], arr[pick(gen)]);
+    }
+    else if (pattern == "reversed")
+    {
+        reverse(arr.begin(), arr.end());
+    }
+}
+
+// Time quickSort and the generic (radix) sort against std::sort and qsort
+void benchmark(size_t maxSize)
 {
+    const vector<string> patterns = {"random", "sorted", "nearly_sorted", "reversed", "equal"};
+    mt19937 gen(12345);
 
-    if (low < high)
+    cout << "size,pattern,quickSort_s,std_sort_s,qsort_s,generic_sort_s" << endl;
+    for (size_t n = 100000; n <= maxSize; n *= 10)
     {
+        vector<int> input(n), work(n);
+        for (const auto &pattern : patterns)
+        {
+            fillPattern(input, pattern, gen);
+            double times[4];
+            vector<int> expected;
+
+            for (int algo = 0; algo < 4; algo++)
+            {
+                work = input;
+                auto start = chrono::steady_clock::now();
+                if (algo == 0)
+                    quickSort(work, 0, (ptrdiff_t)n - 1);
+                else if (algo == 1)
+                    sort(work.begin(), work.end());
+                else if (algo == 2)
+                    qsort(work.data(), n, sizeof(int), compareInts);
+                else
+                    sorting::sort(work.begin(), work.end());
+                auto end = chrono::steady_clock::now();
+                times[algo] = chrono::duration<double>(end - start).count();
 
-        // pi is the partition return index of pivot
-        int pi = partition(arr, low, high);
-        // Recursion calls for smaller elements
-        // and greater or equals elements
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
+                if (algo == 0)
+                    expected = work;
+                else if (work != expected)
+                    cerr << "Result mismatch for " << pattern << " n=" << n << endl;
+            }
+            cout << n << "," << pattern << "," << times[0] << "," << times[1] << "," << times[2] << "," << times[3] << endl;
+        }
     }
 }
 
-int main()
+int main(int argc, char **argv)
 {
     vector<int> arr = {10, 7, 8, 9, 1, 5};
     int n = arr.size();
@@ -61,5 +235,27 @@ int main()
         cout << arr[i] << " ";
     }
     cout << endl;
+
+    // Generic sort: 64-bit keys descending, records by a projected key
+    vector<int64_t> keys = {5000000000LL, -3, 42, 1LL << 40, 0};
+    sorting::sort(keys.begin(), keys.end(), greater<>());
+    for (auto k : keys)
+        cout << k << " ";
+    cout << endl;
+
+    struct Record
+    {
+        double score;
+        string name;
+    };
+    vector<Record> records = {{2.5, "b"}, {-1.0, "a"}, {9.75, "d"}, {3.0, "c"}};
+    sorting::sort(records.begin(), records.end(), less<>(), [](const Record &r) { return r.score; });
+    for (const auto &r : records)
+        cout << r.name << "(" << r.score << ") ";
+    cout << endl;
+
+    // Optional benchmark: ./quick_sort <max size>, sizes go 1e5, 1e6, ... up to 1e9
+    if (argc > 1)
+        benchmark(min<size_t>(stoull(argv[1]), 1000000000ULL));
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,23 @@
+#ifndef QUICK_SORT_H
+#define QUICK_SORT_H
+
+// Introsort kernel for int keys, implemented in quick_sort.c.
+// Link quick_sort.c built with -DQUICK_SORT_NO_MAIN to use it from
+// another program (see mpi_sample_sort.c).
+
+// Partition modes
+#define PARTITION_BRANCHY 0  // three-way partition only
+#define PARTITION_BLOCK 1    // branchless scalar block partition
+#define PARTITION_SIMD 2     // AVX2 / AVX-512 compress-store partition
+
+extern int partitionMode;
+
+void quickSort(int arr[], int low, int high);
+void introSort(int arr[], int low, int high, int depthLimit);
+void partition(int arr[], int low, int high, int pivot, int *lt, int *gt);
+int blockPartition(int arr[], int low, int high, int pivot);
+int choosePivot(int arr[], int low, int high);
+void insertionSort(int arr[], int low, int high);
+void heapSort(int arr[], int low, int high);
+
+#endif
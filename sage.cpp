@@ -1,107 +1,710 @@
-# Bellman-Ford Algorithm Visualization in SageMath (with more cycles)
-
-# Create a weighted directed graph
-G = DiGraph()
-
-# Add edges (source, destination, weight)
-G.add_edges([
-    ('A', 'B', 4),
-    ('A', 'C', 2),
-    ('B', 'C', 3),
-    ('B', 'D', 2),
-    ('B', 'E', 3),
-    ('C', 'B', 1),     # Cycle: B → C → B
-    ('C', 'D', 4),
-    ('D', 'E', -1),
-    
-    # Extra edges to increase cycles:
-    ('E', 'A', 2),     # Cycle: A → B → E → A
-    ('D', 'A', 1),     # Cycle: A → B → D → A
-    ('E', 'C', 1),     # Cycle: C → D → E → C
-    ('D', 'C', 2),     # Cycle: C → D → C
-])
-
-# Display basic graph
-G.show(edge_labels=True, layout='spring', figsize=6, vertex_size=600, vertex_labels=True)
-
-# Source vertex
-source = 'A'
-print(f"🔹 Running Bellman-Ford from source: {source}\n")
-
-# Initialize distances and predecessors
-distance = {v: float('inf') for v in G.vertices()}
-predecessor = {v: None for v in G.vertices()}
-distance[source] = 0
-
-# Relax edges |V|-1 times
-for i in range(len(G.vertices()) - 1):
-    for (u, v, w) in G.edges():
-        if distance[u] + w < distance[v]:
-            distance[v] = distance[u] + w
-            predecessor[v] = u
-
-# Detect negative-weight cycles
-negative_cycle_edges = []
-for (u, v, w) in G.edges():
-    if distance[u] + w < distance[v]:
-        print(f"⚠️ Negative weight cycle detected via edge ({u} → {v}) with weight {w}")
-        negative_cycle_edges.append((u, v))
-
-# Print shortest distances
-print("\n📏 Shortest Distances from", source)
-for v, d in distance.items():
-    print(f"  {source} → {v}: {d}")
-
-# Print predecessor table
-print("\n🧭 Predecessors")
-for v, p in predecessor.items():
-    print(f"  {v} ← {p}")
-
-# Function to reconstruct path from source to any vertex
-def reconstruct_path(v):
-    if distance[v] == float('inf'):
-        return None  # unreachable
-    path = []
-    while v is not None:
-        path.insert(0, v)
-        v = predecessor[v]
-    return path
-
-# Print all shortest paths
-print("\n🛤️ Final Shortest Paths from", source)
-for v in G.vertices():
-    if v == source:
-        continue
-    path = reconstruct_path(v)
-    if path:
-        print(f"  {source} → {v}: {' → '.join(path)} (Cost = {distance[path[-1]]})")
-    else:
-        print(f"  {source} → {v}: Unreachable")
-
-# Collect shortest path tree edges
-shortest_path_edges = [(predecessor[v], v) for v in G.vertices() if predecessor[v] is not None]
-
-# Get layout for consistent positions
-pos = G.layout('spring')
-
-# Base graph
-base_plot = G.plot(
-    pos=pos,
-    edge_labels=True,
-    vertex_size=600,
-    vertex_labels=True,
-    edge_color='gray',
-    figsize=6
-)
-
-# Highlight shortest paths in red
-highlight_shortest = sum([line([pos[e[0]], pos[e[1]]], color='red', thickness=3) for e in shortest_path_edges])
-
-# Highlight negative cycle edges in orange dashed
-highlight_negative = sum([line([pos[e[0]], pos[e[1]]], color='orange', thickness=4, linestyle='--') for e in negative_cycle_edges])
-
-# Combine plots
-final_plot = base_plot + highlight_shortest + highlight_negative
-
-# Show the final visualization
-final_plot.show(figsize=6)
+// Bellman-Ford shortest paths on a CSR graph (native C++ port of the
+// original SageMath visualization script).
+//
+// Usage: ./sage [edge_list|-] [source] [bf|spfa|yen|tarjan|parallel|delta|check]
+// "check" runs every algorithm on the graph (and on a built-in graph with
+// a zero-weight cycle) and verifies that distances and paths agree.
+// Build with -fopenmp for the multithreaded parallel / delta modes.
+// Without an edge list (or with "-") the example graph from the script
+// (A..E) is used.
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <limits>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.hpp"
+
+using namespace std;
+
+const double INF = numeric_limits<double>::infinity();
+
+struct SSSPResult {
+    vector<double> distance;
+    vector<int> predecessor;                   // -1 for none
+    vector<int> negativeCycle;                 // vertices of one negative cycle, in order
+    vector<pair<int, int>> negativeCycleEdges; // edges of that cycle
+    long long relaxations = 0;                 // successful distance updates
+    long long rounds = 0;                      // passes (bf / yen) or queue pops (spfa)
+};
+
+void initResult(const CSRGraph& g, int source, SSSPResult& r) {
+    r.distance.assign(g.numVertices, INF);
+    r.predecessor.assign(g.numVertices, -1);
+    r.distance[source] = 0;
+}
+
+// Cheapest u -> v edge weight (INF if there is none)
+double edgeWeight(const CSRGraph& g, int u, int v) {
+    double w = INF;
+    for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k)
+        if (g.targets[k] == v && g.weights[k] < w) w = g.weights[k];
+    return w;
+}
+
+// Store cycle (listed in edge order) in the result if its weight is
+// negative; returns whether it was accepted
+bool setNegativeCycle(const CSRGraph& g, const vector<int>& cycle, SSSPResult& r) {
+    double weight = 0;
+    for (size_t i = 0; i < cycle.size(); ++i)
+        weight += edgeWeight(g, cycle[i], cycle[(i + 1) % cycle.size()]);
+    if (cycle.empty() || !(weight < 0)) return false;
+
+    r.negativeCycle = cycle;
+    r.negativeCycleEdges.clear();
+    for (size_t i = 0; i < cycle.size(); ++i)
+        r.negativeCycleEdges.push_back({cycle[i], cycle[(i + 1) % cycle.size()]});
+    return true;
+}
+
+// Walk the predecessor graph looking for a cycle; every vertex is visited
+// once, so a check costs O(V). Returns the cycle in edge order, or empty.
+vector<int> findPredecessorCycle(const vector<int>& pred) {
+    int n = pred.size();
+    vector<int> walk(n, -1);  // start vertex of the walk that reached v
+    for (int start = 0; start < n; ++start) {
+        int v = start;
+        while (v != -1 && walk[v] == -1) {
+            walk[v] = start;
+            v = pred[v];
+        }
+        if (v == -1 || walk[v] != start) continue;
+
+        // v is on a cycle found by this walk: collect it backwards
+        vector<int> cycle = {v};
+        for (int u = pred[v]; u != v; u = pred[u])
+            cycle.push_back(u);
+        return vector<int>(cycle.rbegin(), cycle.rend());
+    }
+    return {};
+}
+
+// Periodic check used by the round-based solvers: stop as soon as the
+// predecessor graph holds a (negative) cycle
+bool checkPredecessorCycle(const CSRGraph& g, SSSPResult& r) {
+    return setNegativeCycle(g, findPredecessorCycle(r.predecessor), r);
+}
+
+// Last resort once a solver has used up its rounds: take the first edge
+// that can still relax and follow predecessors |V| steps back, which
+// lands on a negative cycle
+void extractNegativeCycle(const CSRGraph& g, SSSPResult& r) {
+    if (!r.negativeCycle.empty()) return;
+    for (int u = 0; u < g.numVertices; ++u) {
+        if (r.distance[u] == INF) continue;
+        for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+            int v = g.targets[k];
+            if (!(r.distance[u] + g.weights[k] < r.distance[v])) continue;
+
+            // Predecessor graph with the pending relaxation u -> v applied,
+            // read from the shared array instead of a per-edge copy
+            auto pred = [&](int x) { return x == v ? u : r.predecessor[x]; };
+            int x = v;
+            for (int i = 0; i < g.numVertices && x != -1; ++i) x = pred(x);
+            if (x == -1) continue;
+
+            vector<int> cycle = {x};
+            for (int y = pred(x); y != x; y = pred(y))
+                cycle.push_back(y);
+            if (setNegativeCycle(g, vector<int>(cycle.rbegin(), cycle.rend()), r)) return;
+        }
+    }
+}
+
+// Classic Bellman-Ford: up to |V|-1 rounds over all edges, stopping as
+// soon as a round relaxes nothing or the predecessors close a cycle
+SSSPResult bellmanFord(const CSRGraph& g, int source) {
+    SSSPResult r;
+    initResult(g, source, r);
+
+    bool changed = true;
+    for (int i = 0; i < g.numVertices - 1 && changed; ++i) {
+        changed = false;
+        ++r.rounds;
+        for (int u = 0; u < g.numVertices; ++u) {
+            double du = r.distance[u];
+            if (du == INF) continue;
+            for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                int v = g.targets[k];
+                if (du + g.weights[k] < r.distance[v]) {
+                    r.distance[v] = du + g.weights[k];
+                    r.predecessor[v] = u;
+                    ++r.relaxations;
+                    changed = true;
+                }
+            }
+        }
+        if (changed && checkPredecessorCycle(g, r)) return r;
+    }
+
+    if (changed) extractNegativeCycle(g, r);
+    return r;
+}
+
+// Queue-based Bellman-Ford (SPFA): only vertices whose distance changed
+// are rescanned. The predecessor graph is walked after every |V|
+// relaxations; a path that reaches |V| edges also proves a negative cycle.
+SSSPResult spfa(const CSRGraph& g, int source) {
+    SSSPResult r;
+    initResult(g, source, r);
+
+    vector<char> inQueue(g.numVertices, 0);
+    vector<int> pathLength(g.numVertices, 0);
+    deque<int> queue = {source};
+    inQueue[source] = 1;
+    bool cycle = false;
+
+    while (!queue.empty() && !cycle) {
+        int u = queue.front();
+        queue.pop_front();
+        inQueue[u] = 0;
+        ++r.rounds;
+
+        double du = r.distance[u];
+        for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+            int v = g.targets[k];
+            if (du + g.weights[k] < r.distance[v]) {
+                r.distance[v] = du + g.weights[k];
+                r.predecessor[v] = u;
+                ++r.relaxations;
+                pathLength[v] = pathLength[u] + 1;
+                if (pathLength[v] >= g.numVertices ||
+                    (r.relaxations % g.numVertices == 0 && checkPredecessorCycle(g, r))) {
+                    cycle = true;
+                    break;
+                }
+                if (!inQueue[v]) {
+                    queue.push_back(v);
+                    inQueue[v] = 1;
+                }
+            }
+        }
+    }
+
+    if (cycle && !checkPredecessorCycle(g, r))
+        extractNegativeCycle(g, r);
+    return r;
+}
+
+// Yen's ordering: each round scans vertices upward relaxing only edges to
+// higher IDs, then downward relaxing edges to lower IDs, which bounds the
+// rounds by |V|/2. Vertices unchanged since their last scan are skipped.
+SSSPResult bellmanFordYen(const CSRGraph& g, int source) {
+    SSSPResult r;
+    initResult(g, source, r);
+
+    // Pending forward / backward scans per vertex
+    vector<char> dirty[2] = {vector<char>(g.numVertices, 0), vector<char>(g.numVertices, 0)};
+    dirty[0][source] = dirty[1][source] = 1;
+    int maxRounds = g.numVertices / 2 + 1;
+
+    bool changed = true;
+    for (int i = 0; i < maxRounds && changed; ++i) {
+        changed = false;
+        ++r.rounds;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int j = 0; j < g.numVertices; ++j) {
+                int u = pass == 0 ? j : g.numVertices - 1 - j;
+                if (!dirty[pass][u]) continue;
+                dirty[pass][u] = 0;
+                double du = r.distance[u];
+                for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.targets[k];
+                    if ((pass == 0) != (v > u)) continue;
+                    if (du + g.weights[k] < r.distance[v]) {
+                        r.distance[v] = du + g.weights[k];
+                        r.predecessor[v] = u;
+                        dirty[0][v] = dirty[1][v] = 1;
+                        ++r.relaxations;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        if (changed && checkPredecessorCycle(g, r)) return r;
+    }
+
+    if (changed) extractNegativeCycle(g, r);
+    return r;
+}
+
+// SPFA with Tarjan's subtree disassembly. The shortest-path tree is kept
+// as a preorder list with depths. When v improves, its whole subtree is
+// stale: it is unlinked (and its queued vertices skipped), and if the
+// improving vertex u lies inside it, u -> v closes a negative cycle,
+// detected the moment it forms.
+SSSPResult spfaTarjan(const CSRGraph& g, int source) {
+    SSSPResult r;
+    initResult(g, source, r);
+
+    int n = g.numVertices;
+    vector<int> next(n, -1), prev(n, -1), depth(n, 0);
+    vector<char> inTree(n, 0), inQueue(n, 0);
+    next[source] = prev[source] = source;
+    inTree[source] = 1;
+    deque<int> queue = {source};
+    inQueue[source] = 1;
+
+    while (!queue.empty()) {
+        int u = queue.front();
+        queue.pop_front();
+        inQueue[u] = 0;
+        if (!inTree[u]) continue;  // disassembled: an ancestor improved, u will be revisited
+        ++r.rounds;
+
+        double du = r.distance[u];
+        for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+            int v = g.targets[k];
+            if (!(du + g.weights[k] < r.distance[v])) continue;
+
+            if (inTree[v]) {
+                // Unlink v and its subtree (consecutive deeper vertices in preorder)
+                int last = v;
+                bool cycle = (u == v);
+                for (int x = next[v]; x != v && depth[x] > depth[v]; x = next[x]) {
+                    if (x == u) cycle = true;
+                    inTree[x] = 0;
+                    last = x;
+                }
+                if (cycle) {
+                    vector<int> path;  // v -> ... -> u along the tree
+                    for (int x = u; x != v; x = r.predecessor[x])
+                        path.push_back(x);
+                    path.push_back(v);
+                    setNegativeCycle(g, vector<int>(path.rbegin(), path.rend()), r);
+                    return r;
+                }
+                next[prev[v]] = next[last];
+                prev[next[last]] = prev[v];
+            }
+
+            r.distance[v] = du + g.weights[k];
+            r.predecessor[v] = u;
+            ++r.relaxations;
+
+            // Attach v as the first child of u
+            depth[v] = depth[u] + 1;
+            next[v] = next[u];
+            prev[next[u]] = v;
+            next[u] = v;
+            prev[v] = u;
+            inTree[v] = 1;
+            if (!inQueue[v]) {
+                queue.push_back(v);
+                inQueue[v] = 1;
+            }
+        }
+    }
+    return r;
+}
+
+// ---------------- Multithreaded SSSP ----------------
+
+double atomicLoad(double* dist) {
+    double value;
+    __atomic_load(dist, &value, __ATOMIC_RELAXED);
+    return value;
+}
+
+// dist = min(dist, value) without locks; true if this call lowered it
+bool atomicMin(double* dist, double value) {
+    double current = atomicLoad(dist);
+    while (value < current) {
+        if (__atomic_compare_exchange(dist, &current, &value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return true;
+    }
+    return false;
+}
+
+int numThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// Parallel relaxation only tracks distances reliably; afterwards rebuild
+// the shortest-path tree by a level-synchronous BFS from the source over
+// tight edges (dist[u] + w == dist[v]). A vertex takes its predecessor
+// from a vertex already in the tree, so zero-weight cycles cannot turn
+// into predecessor loops.
+void fixPredecessors(const CSRGraph& g, int source, SSSPResult& r) {
+    fill(r.predecessor.begin(), r.predecessor.end(), -1);
+    vector<char> inTree(g.numVertices, 0);
+    inTree[source] = 1;
+    vector<int> frontier = {source};
+
+    while (!frontier.empty()) {
+        vector<vector<int>> next(numThreads());
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+#ifdef _OPENMP
+            vector<int>& mine = next[omp_get_thread_num()];
+#else
+            vector<int>& mine = next[0];
+#endif
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic, 64)
+#endif
+            for (size_t i = 0; i < frontier.size(); ++i) {
+                int u = frontier[i];
+                for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.targets[k];
+                    char expected = 0, claimed = 1;
+                    if (r.distance[u] + g.weights[k] == r.distance[v] &&
+                        __atomic_compare_exchange(&inTree[v], &expected, &claimed, false,
+                                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                        r.predecessor[v] = u;
+                        mine.push_back(v);
+                    }
+                }
+            }
+        }
+        frontier.clear();
+        for (const auto& list : next)
+            frontier.insert(frontier.end(), list.begin(), list.end());
+    }
+}
+
+// Split the vertices into ranges holding about the same number of edges,
+// a few per thread so that skewed degrees still balance
+vector<int> edgePartitions(const CSRGraph& g, int parts) {
+    vector<int> bounds = {0};
+    for (int p = 1; p < parts; ++p) {
+        long long target = g.numEdges() * p / parts;
+        int u = upper_bound(g.offsets.begin(), g.offsets.end(), target) - g.offsets.begin() - 1;
+        bounds.push_back(max(u, bounds.back()));
+    }
+    bounds.push_back(g.numVertices);
+    return bounds;
+}
+
+// Parallel Bellman-Ford: edge partitions are relaxed concurrently with
+// atomic min-updates, and only vertices lowered in the previous round
+// are rescanned. Works with negative weights; the predecessor graph is
+// checked for a negative cycle after every round.
+SSSPResult parallelBellmanFord(const CSRGraph& g, int source) {
+    SSSPResult r;
+    initResult(g, source, r);
+
+    vector<char> active(g.numVertices, 0), nextActive(g.numVertices, 0);
+    active[source] = 1;
+    vector<int> bounds = edgePartitions(g, 4 * numThreads());
+    int parts = bounds.size() - 1;
+    bool changed = true;
+
+    for (int i = 0; i < g.numVertices && changed; ++i) {
+        changed = false;
+        ++r.rounds;
+        long long relaxations = 0;
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) reduction(||:changed) reduction(+:relaxations)
+#endif
+        for (int p = 0; p < parts; ++p) {
+            for (int u = bounds[p]; u < bounds[p + 1]; ++u) {
+                if (!active[u]) continue;
+                active[u] = 0;
+                double du = atomicLoad(&r.distance[u]);
+                for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.targets[k];
+                    if (atomicMin(&r.distance[v], du + g.weights[k])) {
+                        __atomic_store_n(&r.predecessor[v], u, __ATOMIC_RELAXED);
+                        __atomic_store_n(&nextActive[v], 1, __ATOMIC_RELAXED);
+                        ++relaxations;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        r.relaxations += relaxations;
+        swap(active, nextActive);
+
+        // Racing updates can leave a predecessor cycle that is not
+        // negative; setNegativeCycle checks the weight before accepting
+        if (changed && checkPredecessorCycle(g, r)) return r;
+    }
+
+    // Still changing after |V| rounds: there is a negative cycle
+    if (changed) {
+        extractNegativeCycle(g, r);
+        return r;
+    }
+    fixPredecessors(g, source, r);
+    return r;
+}
+
+// Delta-stepping (Meyer & Sanders) for non-negative weights. Vertices sit
+// in buckets of width delta; the lowest bucket is settled by repeatedly
+// relaxing its light edges (w <= delta) in parallel, then the heavy edges
+// of everything settled in it are relaxed once. Falls back to parallel
+// Bellman-Ford when a negative weight is present.
+SSSPResult deltaStepping(const CSRGraph& g, int source, double delta = 0) {
+    double maxWeight = 0;
+    for (double w : g.weights) {
+        if (w < 0) return parallelBellmanFord(g, source);
+        maxWeight = max(maxWeight, w);
+    }
+    // Default bucket width: max weight / average degree
+    if (delta <= 0) {
+        double avgDegree = g.numVertices ? (double)g.numEdges() / g.numVertices : 1;
+        delta = maxWeight / max(avgDegree, 1.0);
+        if (delta <= 0) delta = 1;
+    }
+
+    SSSPResult r;
+    initResult(g, source, r);
+
+    vector<vector<int>> buckets(1, vector<int>{source});
+    vector<long long> seen(g.numVertices, -1);  // stamp of the last frontier holding v
+    long long stamp = 0;
+
+    auto bucketOf = [&](int v) { return (size_t)(r.distance[v] / delta); };
+
+    // Relax the light or heavy edges of the frontier; lowered vertices go
+    // to per-thread lists and are bucketed afterwards
+    auto relax = [&](const vector<int>& frontier, bool light) {
+        vector<vector<int>> updated(numThreads());
+        long long relaxations = 0;
+#ifdef _OPENMP
+        #pragma omp parallel reduction(+:relaxations)
+#endif
+        {
+#ifdef _OPENMP
+            vector<int>& mine = updated[omp_get_thread_num()];
+#else
+            vector<int>& mine = updated[0];
+#endif
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic, 64)
+#endif
+            for (size_t i = 0; i < frontier.size(); ++i) {
+                int u = frontier[i];
+                double du = atomicLoad(&r.distance[u]);
+                for (long long k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    double w = g.weights[k];
+                    if ((w <= delta) != light) continue;
+                    if (atomicMin(&r.distance[g.targets[k]], du + w)) {
+                        mine.push_back(g.targets[k]);
+                        ++relaxations;
+                    }
+                }
+            }
+        }
+        r.relaxations += relaxations;
+        for (const auto& list : updated) {
+            for (int v : list) {
+                size_t b = bucketOf(v);
+                if (b >= buckets.size()) buckets.resize(b + 1);
+                buckets[b].push_back(v);
+            }
+        }
+    };
+
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        vector<int> settled;
+        while (!buckets[b].empty()) {
+            ++r.rounds;
+            // Drop stale entries (moved to a lower bucket) and duplicates
+            vector<int> frontier;
+            ++stamp;
+            for (int v : buckets[b]) {
+                if (bucketOf(v) == b && seen[v] != stamp) {
+                    seen[v] = stamp;
+                    frontier.push_back(v);
+                }
+            }
+            buckets[b].clear();
+            settled.insert(settled.end(), frontier.begin(), frontier.end());
+            relax(frontier, true);
+        }
+        sort(settled.begin(), settled.end());
+        settled.erase(unique(settled.begin(), settled.end()), settled.end());
+        relax(settled, false);
+    }
+
+    fixPredecessors(g, source, r);
+    return r;
+}
+
+// Reconstruct the path from the source to v; empty if unreachable or if
+// the predecessor chain loops (v is behind a negative cycle)
+vector<int> reconstructPath(const SSSPResult& r, int v) {
+    vector<int> path;
+    if (r.distance[v] == INF) return path;
+    for (int u = v; u != -1; u = r.predecessor[u]) {
+        if (path.size() > r.distance.size()) return {};
+        path.push_back(u);
+    }
+    return vector<int>(path.rbegin(), path.rend());
+}
+
+// The example graph from the original script, vertices A..E
+CSRGraph exampleGraph() {
+    vector<Edge> edges = {
+        {0, 1, 4},   // A -> B
+        {0, 2, 2},   // A -> C
+        {1, 2, 3},   // B -> C
+        {1, 3, 2},   // B -> D
+        {1, 4, 3},   // B -> E
+        {2, 1, 1},   // C -> B   Cycle: B -> C -> B
+        {2, 3, 4},   // C -> D
+        {3, 4, -1},  // D -> E
+
+        // Extra edges to increase cycles:
+        {4, 0, 2},   // E -> A   Cycle: A -> B -> E -> A
+        {3, 0, 1},   // D -> A   Cycle: A -> B -> D -> A
+        {4, 2, 1},   // E -> C   Cycle: C -> D -> E -> C
+        {3, 2, 2},   // D -> C   Cycle: C -> D -> C
+    };
+    CSRGraph g = buildCSR(5, edges);
+    g.names = {"A", "B", "C", "D", "E"};
+    return g;
+}
+
+// Zero-weight cycle 1 <-> 2 on the shortest paths; tight edges alone
+// would let 1 and 2 name each other as predecessors
+CSRGraph zeroCycleGraph() {
+    vector<Edge> edges = {{0, 1, 1}, {1, 2, 0}, {2, 1, 0}, {2, 3, 5}};
+    return buildCSR(4, edges);
+}
+
+SSSPResult runAlgorithm(const string& algo, const CSRGraph& g, int source) {
+    if (algo == "spfa") return spfa(g, source);
+    if (algo == "yen") return bellmanFordYen(g, source);
+    if (algo == "tarjan") return spfaTarjan(g, source);
+    if (algo == "parallel") return parallelBellmanFord(g, source);
+    if (algo == "delta") return deltaStepping(g, source);
+    return bellmanFord(g, source);
+}
+
+const char* const ALGORITHMS[] = {"bf", "spfa", "yen", "tarjan", "parallel", "delta"};
+
+bool sameDistance(double a, double b) {
+    return a == b || fabs(a - b) <= 1e-9 * max(1.0, fabs(a));
+}
+
+// Run every algorithm and check it against bf: same distances, same
+// negative-cycle verdict, and every path starts at the source, uses real
+// edges and costs exactly the reported distance. Returns the failure count.
+int checkAllModes(const string& label, const CSRGraph& g, int source) {
+    SSSPResult ref = bellmanFord(g, source);
+    int failures = 0;
+    for (const char* algo : ALGORITHMS) {
+        SSSPResult r = runAlgorithm(algo, g, source);
+        string problem;
+        if (r.negativeCycle.empty() != ref.negativeCycle.empty()) {
+            problem = "negative-cycle verdict differs";
+        } else if (ref.negativeCycle.empty()) {
+            for (int v = 0; v < g.numVertices && problem.empty(); ++v) {
+                if (!sameDistance(r.distance[v], ref.distance[v])) {
+                    problem = "distance of " + g.name(v) + " differs";
+                    continue;
+                }
+                if (r.distance[v] == INF) continue;
+                vector<int> path = reconstructPath(r, v);
+                double cost = 0;
+                for (size_t i = 0; i + 1 < path.size(); ++i)
+                    cost += edgeWeight(g, path[i], path[i + 1]);
+                if (path.empty() || path.front() != source || !sameDistance(cost, r.distance[v]))
+                    problem = "bad path to " + g.name(v);
+            }
+        }
+        if (!problem.empty()) {
+            cout << "  ❌ " << label << " / " << algo << ": " << problem << endl;
+            ++failures;
+        }
+    }
+    if (failures == 0)
+        cout << "  ✅ " << label << ": all algorithms agree" << endl;
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    CSRGraph g;
+    if (argc > 1 && string(argv[1]) != "-") {
+        vector<Edge> edges;
+        int n;
+        if (!loadEdgeList(argv[1], edges, n)) return 1;
+        g = buildCSR(n, edges);
+    } else {
+        g = exampleGraph();
+    }
+
+    int source = argc > 2 ? atoi(argv[2]) : 0;
+    string algo = argc > 3 ? argv[3] : "bf";
+    if (source < 0 || source >= g.numVertices) {
+        cerr << "Source vertex " << source << " out of range" << endl;
+        return 1;
+    }
+
+    cout << "🔹 Running Bellman-Ford (" << algo << ") from source: " << g.name(source)
+         << " on " << g.numVertices << " vertices, " << g.numEdges() << " edges\n" << endl;
+
+    // Cross-check every algorithm on this graph and on the zero-cycle case
+    if (algo == "check") {
+        int failures = checkAllModes("input graph", g, source) + checkAllModes("zero-weight cycle", zeroCycleGraph(), 0);
+        return failures > 0;
+    }
+    if (find(begin(ALGORITHMS), end(ALGORITHMS), algo) == end(ALGORITHMS)) {
+        cerr << "Unknown algorithm " << algo << " (expected bf, spfa, yen, tarjan, parallel, delta or check)" << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    SSSPResult r = runAlgorithm(algo, g, source);
+    auto end = chrono::steady_clock::now();
+
+    for (const auto& e : r.negativeCycleEdges)
+        cout << "⚠️ Negative weight cycle detected via edge (" << g.name(e.first) << " → "
+             << g.name(e.second) << ")" << endl;
+    if (!r.negativeCycle.empty()) {
+        cout << "🔁 Negative cycle: ";
+        for (int v : r.negativeCycle)
+            cout << g.name(v) << " → ";
+        cout << g.name(r.negativeCycle[0]) << endl;
+    }
+
+    cout << "Threads: " << numThreads() << ", rounds: " << r.rounds << ", relaxations: " << r.relaxations << ", time: "
+         << chrono::duration<double>(end - start).count() << " s" << endl;
+
+    // Per-vertex tables only for small graphs
+    const int PRINT_LIMIT = 50;
+    if (g.numVertices > PRINT_LIMIT) return 0;
+
+    cout << "\n📏 Shortest Distances from " << g.name(source) << endl;
+    for (int v = 0; v < g.numVertices; ++v)
+        cout << "  " << g.name(source) << " → " << g.name(v) << ": " << r.distance[v] << endl;
+
+    cout << "\n🧭 Predecessors" << endl;
+    for (int v = 0; v < g.numVertices; ++v)
+        cout << "  " << g.name(v) << " ← " << (r.predecessor[v] < 0 ? "None" : g.name(r.predecessor[v])) << endl;
+
+    cout << "\n🛤️ Final Shortest Paths from " << g.name(source) << endl;
+    for (int v = 0; v < g.numVertices; ++v) {
+        if (v == source) continue;
+        vector<int> path = reconstructPath(r, v);
+        cout << "  " << g.name(source) << " → " << g.name(v) << ": ";
+        if (path.empty()) {
+            cout << (r.distance[v] == INF ? "Unreachable" : "Affected by negative cycle") << endl;
+            continue;
+        }
+        for (size_t i = 0; i < path.size(); ++i)
+            cout << (i ? " → " : "") << g.name(path[i]);
+        cout << " (Cost = " << r.distance[v] << ")" << endl;
+    }
+
+    return 0;
+}
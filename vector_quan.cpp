@@ -2,13 +2,24 @@
 #include <vector>
 #include <cmath>
 #include <cstdlib>
-#include <ctime>
 #include <limits>
+#include <chrono>
+
+#include "dataset.hpp"
+#include "instrument.hpp"
+#include "vq_codebook.hpp"
 
 using namespace std;
 
 typedef vector<double> Vector;
 typedef vector<Vector> Matrix;
+typedef vq::CodeTree<double> CodeTree;
+
+using vq::squaredDistance;
+using vq::splitCentroid;
+using vq::nearestCodeword;
+using vq::treeFromLevels;
+using vq::treeSearch;
 
 // Compute Euclidean distance between two vectors
 double euclideanDistance(const Vector& a, const Vector& b) {
@@ -33,109 +44,405 @@ Vector computeMean(const Matrix& cluster) {
     return mean;
 }
 
-// LBG / k-means-like vector quantization algorithm
-Matrix vectorQuantization(const Matrix& data, int numCentroids, int maxIter = 100, double epsilon = 1e-5) {
-    srand(time(0));
-    Matrix codebook;
+// LBG / k-means-like vector quantization algorithm. levels, if given,
+// receives the codebook of every split level (see vq::trainLbg).
+Matrix vectorQuantization(const Matrix& data, int numCentroids, int maxIter = 100, double epsilon = 1e-5,
+                          vector<Matrix>* levels = nullptr) {
+    return vq::trainLbg(data, numCentroids, maxIter, epsilon, levels);
+}
+
+// Quantize data using the codebook
+Matrix quantize(const Matrix& data, const Matrix& codebook) {
+    INSTR_SCOPE("encode_full");
+    INSTR_COUNT("distance_evals", (long long)data.size() * codebook.size());
+    Matrix quantized;
+    for (const auto& vec : data) {
+        double minDist = numeric_limits<double>::max();
+        int bestIdx = 0;
+        for (size_t i = 0; i < codebook.size(); ++i) {
+            double dist = euclideanDistance(vec, codebook[i]);
+            if (dist < minDist) {
+                minDist = dist;
+                bestIdx = i;
+            }
+        }
+        quantized.push_back(codebook[bestIdx]);
+    }
+    return quantized;
+}
+
+// ---------------- Float32 / mixed-precision batched VQ ----------------
+//
+// Data and codewords are stored as row-major float arrays (half the memory
+// traffic of Matrix), and the assignment step handles BATCH_ROWS vectors at
+// a time: ||x - c||^2 = ||x||^2 - 2 x.c + ||c||^2, where all the x.c come
+// from one blocked matrix product X * C^T. ||x||^2 is the same for every
+// codeword, so the nearest one minimizes ||c||^2 - 2 x.c.
+//
+// Precision: the products accumulate in float within a GEMM_KC-wide slice
+// of the dimensions and in double across slices. Codeword norms,
+// centroid sums and the codebook itself stay in double. Data and codebook
+// are centered on the data mean first, which keeps the norms small and
+// the expansion free of cancellation for data far from the origin.
+
+const int BATCH_ROWS = 256;   // vectors per distance batch
+const int GEMM_MR = 4;        // register tile: GEMM_MR vectors x GEMM_NR codewords
+const int GEMM_NR = 16;
+const int GEMM_KC = 128;      // dimensions per packed slice (panel stays in L1/L2)
+
+struct FloatMatrix {
+    int rows = 0, cols = 0;
+    vector<float> values;
+
+    float* row(int i) { return &values[(size_t)i * cols]; }
+    const float* row(int i) const { return &values[(size_t)i * cols]; }
+};
+
+// Rows of m minus shift, as floats
+FloatMatrix toFloat(const Matrix& m, const Vector& shift) {
+    FloatMatrix f;
+    f.rows = m.size();
+    f.cols = m.empty() ? 0 : m[0].size();
+    f.values.resize((size_t)f.rows * f.cols);
+    for (int i = 0; i < f.rows; ++i)
+        for (int j = 0; j < f.cols; ++j)
+            f.row(i)[j] = (float)(m[i][j] - shift[j]);
+    return f;
+}
+
+// Pack codewords [j0, j0 + n) restricted to dimensions [p0, p0 + kc) into
+// GEMM_NR-wide panels laid out as panel[p][column], zero padded
+void packPanels(const FloatMatrix& C, int j0, int n, int p0, int kc, vector<float>& packed) {
+    int panels = (n + GEMM_NR - 1) / GEMM_NR;
+    packed.assign((size_t)panels * kc * GEMM_NR, 0.0f);
+    for (int j = 0; j < n; ++j) {
+        const float* c = C.row(j0 + j) + p0;
+        float* panel = &packed[(size_t)(j / GEMM_NR) * kc * GEMM_NR] + j % GEMM_NR;
+        for (int p = 0; p < kc; ++p)
+            panel[p * GEMM_NR] = c[p];
+    }
+}
+
+// The whole codebook packed once per assignment pass: slices[s] holds the
+// panels of dimensions [s * GEMM_KC, s * GEMM_KC + kc), shared read-only by
+// every batch
+struct PackedCodebook {
+    int rows = 0;
+    vector<vector<float>> slices;
+};
+
+PackedCodebook packCodebook(const FloatMatrix& C) {
+    PackedCodebook P;
+    P.rows = C.rows;
+    for (int p0 = 0; p0 < C.cols; p0 += GEMM_KC) {
+        P.slices.emplace_back();
+        packPanels(C, 0, C.rows, p0, min(GEMM_KC, C.cols - p0), P.slices.back());
+    }
+    return P;
+}
+
+// acc[r][c] = sum over p of x[r][p] * panel[p][c]; the fixed-size tile
+// lives in vector registers and the c loop vectorizes
+inline void microKernel(const float* const x[GEMM_MR], const float* panel, int kc,
+                        double* out, int ldOut, int mr, int nr) {
+    float acc[GEMM_MR][GEMM_NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        const float* b = panel + p * GEMM_NR;
+        for (int r = 0; r < GEMM_MR; ++r) {
+            float a = x[r][p];
+            for (int c = 0; c < GEMM_NR; ++c)
+                acc[r][c] += a * b[c];
+        }
+    }
+    for (int r = 0; r < mr; ++r)
+        for (int c = 0; c < nr; ++c)
+            out[r * ldOut + c] += acc[r][c];
+}
+
+// dots[i * C.rows + j] = X row (i0 + i) . C row j, for i < m
+void batchDots(const FloatMatrix& X, int i0, int m, const PackedCodebook& C, vector<double>& dots) {
+    int k = C.rows, d = X.cols;
+    dots.assign((size_t)m * k, 0.0);
+    for (int p0 = 0; p0 < d; p0 += GEMM_KC) {
+        int kc = min(GEMM_KC, d - p0);
+        const vector<float>& packed = C.slices[p0 / GEMM_KC];
+        for (int i = 0; i < m; i += GEMM_MR) {
+            int mr = min(GEMM_MR, m - i);
+            const float* x[GEMM_MR];
+            for (int r = 0; r < GEMM_MR; ++r)
+                x[r] = X.row(i0 + i + min(r, mr - 1)) + p0;   // edge rows repeat the last one
+            for (int j = 0; j < k; j += GEMM_NR)
+                microKernel(x, &packed[(size_t)(j / GEMM_NR) * kc * GEMM_NR], kc,
+                            &dots[(size_t)i * k + j], k, mr, min(GEMM_NR, k - j));
+        }
+    }
+}
 
-    // Initialize with one centroid (mean of all data)
-    Vector initialCentroid = computeMean(data);
-    codebook.push_back(initialCentroid);
+// Nearest codeword of every row of X
+vector<int> assignBatched(const FloatMatrix& X, const FloatMatrix& C) {
+    vector<double> norms(C.rows, 0.0);
+    for (int j = 0; j < C.rows; ++j)
+        for (int p = 0; p < C.cols; ++p)
+            norms[j] += (double)C.row(j)[p] * C.row(j)[p];
+    PackedCodebook packed = packCodebook(C);
 
-    // Expand to desired number of centroids
-    while (codebook.size() < numCentroids) {
-        // Splitting step
+    vector<int> labels(X.rows);
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i0 = 0; i0 < X.rows; i0 += BATCH_ROWS) {
+        int m = min(BATCH_ROWS, X.rows - i0);
+        vector<double> dots;
+        batchDots(X, i0, m, packed, dots);
+        for (int i = 0; i < m; ++i) {
+            const double* row = &dots[(size_t)i * C.rows];
+            double best = numeric_limits<double>::max();
+            for (int j = 0; j < C.rows; ++j) {
+                double dist = norms[j] - 2.0 * row[j];
+                if (dist < best) {
+                    best = dist;
+                    labels[i0 + i] = j;
+                }
+            }
+        }
+    }
+    INSTR_COUNT("distance_evals", (long long)X.rows * C.rows);
+    return labels;
+}
+
+// LBG as in vectorQuantization, with float data and batched assignment
+// X holds the training vectors minus shift, their mean (see loadDatasetFloat).
+Matrix vectorQuantizationFloat(const FloatMatrix& X, const Vector& shift, int numCentroids, int maxIter = 100,
+                               double epsilon = 1e-5, vector<Matrix>* levels = nullptr) {
+    int d = X.cols;
+
+    Matrix codebook(1, shift);   // kept uncentered, so splits match vectorQuantization
+    vector<int> labels;
+    if (levels != nullptr) levels->assign(1, codebook);
+
+    while ((int)codebook.size() < numCentroids) {
         Matrix newCodebook;
         for (const auto& c : codebook) {
-            Vector plus(c), minus(c);
-            for (auto& val : plus) val *= (1 + epsilon);
-            for (auto& val : minus) val *= (1 - epsilon);
+            Vector plus, minus;
+            splitCentroid(c, epsilon, plus, minus);
             newCodebook.push_back(plus);
             newCodebook.push_back(minus);
         }
         codebook = newCodebook;
+        vector<int> previous;
 
-        // K-means refinement
         for (int iter = 0; iter < maxIter; ++iter) {
-            vector<Matrix> clusters(codebook.size());
-
-            // Assign vectors to nearest centroid
-            for (const auto& vec : data) {
-                double minDist = numeric_limits<double>::max();
-                int bestIdx = 0;
-                for (size_t i = 0; i < codebook.size(); ++i) {
-                    double dist = euclideanDistance(vec, codebook[i]);
-                    if (dist < minDist) {
-                        minDist = dist;
-                        bestIdx = i;
-                    }
-                }
-                clusters[bestIdx].push_back(vec);
+            INSTR_COUNT("iterations", 1);
+            {
+                INSTR_SCOPE("assign");
+                labels = assignBatched(X, toFloat(codebook, shift));
+            }
+            if (!previous.empty()) {
+                long long changes = 0;
+                for (size_t i = 0; i < labels.size(); ++i) changes += labels[i] != previous[i];
+                INSTR_COUNT("label_changes", changes);
             }
+            previous = labels;
 
-            // Update centroids
-            Matrix newCodebook;
-            for (size_t i = 0; i < codebook.size(); ++i) {
-                if (!clusters[i].empty()) {
-                    newCodebook.push_back(computeMean(clusters[i]));
-                } else {
-                    // Keep old centroid if cluster is empty
-                    newCodebook.push_back(codebook[i]);
-                }
+            // Update: sums in double
+            INSTR_SCOPE("update");
+            Matrix sums(codebook.size(), Vector(d, 0.0));
+            vector<long long> counts(codebook.size(), 0);
+            for (int i = 0; i < X.rows; ++i) {
+                const float* x = X.row(i);
+                Vector& s = sums[labels[i]];
+                for (int p = 0; p < d; ++p) s[p] += x[p];
+                counts[labels[i]]++;
             }
 
-            // Check for convergence
             double totalChange = 0.0;
-            for (size_t i = 0; i < codebook.size(); ++i)
-                totalChange += euclideanDistance(codebook[i], newCodebook[i]);
-
-            codebook = newCodebook;
+            for (size_t j = 0; j < codebook.size(); ++j) {
+                if (counts[j] == 0) continue;   // keep old centroid if cluster is empty
+                for (int p = 0; p < d; ++p) sums[j][p] = sums[j][p] / counts[j] + shift[p];
+                totalChange += euclideanDistance(codebook[j], sums[j]);
+                codebook[j] = sums[j];
+            }
             if (totalChange < epsilon) break;
         }
+        if (levels != nullptr) levels->push_back(codebook);
     }
 
     return codebook;
 }
 
-// Quantize data using the codebook
-Matrix quantize(const Matrix& data, const Matrix& codebook) {
+// Full-search quantization through the batched float path
+Matrix quantizeFloat(const Matrix& data, const Matrix& codebook) {
+    INSTR_SCOPE("encode_float32");
+    Vector shift = computeMean(data);
+    vector<int> labels = assignBatched(toFloat(data, shift), toFloat(codebook, shift));
     Matrix quantized;
-    for (const auto& vec : data) {
-        double minDist = numeric_limits<double>::max();
-        int bestIdx = 0;
-        for (size_t i = 0; i < codebook.size(); ++i) {
-            double dist = euclideanDistance(vec, codebook[i]);
-            if (dist < minDist) {
-                minDist = dist;
-                bestIdx = i;
-            }
-        }
-        quantized.push_back(codebook[bestIdx]);
-    }
+    for (int label : labels)
+        quantized.push_back(codebook[label]);
     return quantized;
 }
 
-// Example usage
-int main() {
-    // Generate synthetic 2D data
-    Matrix data;
-    for (int i = 0; i < 1000; ++i) {
-        double x = (double)rand() / RAND_MAX;
-        double y = (double)rand() / RAND_MAX;
-        data.push_back({x, y});
+// ---------------- Tree-structured VQ ----------------
+
+// Quantize data using the tree (O(log K) per vector)
+Matrix quantizeTree(const Matrix& data, const CodeTree& tree) {
+    INSTR_SCOPE("encode_tree");
+    Matrix quantized;
+    for (const auto& vec : data)
+        quantized.push_back(tree.leaves[treeSearch(vec, tree)]);
+    return quantized;
+}
+
+// ---------------- Multistage (residual) VQ ----------------
+
+// One LBG codebook per stage, trained on the previous stages' residuals,
+// with the bits of a numCentroids codebook split over the stages
+vector<Matrix> buildMultistageCodebook(const Matrix& data, int numStages, int numCentroids,
+                                       int maxIter = 100, double epsilon = 1e-5) {
+    return vq::buildMultistageCodebook(data, vq::stageSizes(numCentroids, numStages),
+                                       [&](const Matrix& residual, int size) {
+        return vectorQuantization(residual, size, maxIter, epsilon);
+    });
+}
+
+// Quantize data stage by stage and sum the chosen codewords
+Matrix quantizeMultistage(const Matrix& data, const vector<Matrix>& stages) {
+    INSTR_SCOPE("encode_multistage");
+    Matrix quantized;
+    for (const auto& vec : data)
+        quantized.push_back(vq::multistageApproximation(vec, stages));
+    return quantized;
+}
+
+// Mean squared quantization error
+double meanSquaredError(const Matrix& data, const Matrix& quantized) {
+    double sum = 0.0;
+    for (size_t i = 0; i < data.size(); ++i)
+        sum += squaredDistance(data[i], quantized[i]);
+    return data.empty() ? 0.0 : sum / data.size();
+}
+
+// Time an encoder over the data and print its rate and distortion
+template <typename Encoder>
+void reportQuality(const string& name, double bits, const Matrix& data, Encoder encode) {
+    auto start = chrono::steady_clock::now();
+    Matrix quantized = encode();
+    auto end = chrono::steady_clock::now();
+    double us = chrono::duration<double, micro>(end - start).count();
+    cout << "  " << name << ": " << bits << " bits/vector, MSE = " << meanSquaredError(data, quantized)
+         << ", encode time = " << us << " us" << endl;
+}
+
+// Load every column of a dataset file as one vector component
+bool loadDataset(const string& path, Matrix& data) {
+    INSTR_SCOPE("io");
+    Dataset ds;
+    if (!ds.open(path)) return false;
+    if (ds.numColumns() == 0 || ds.numRows() == 0) {
+        cerr << path << ": empty dataset" << endl;
+        return false;
+    }
+    data.assign(ds.numRows(), Vector(ds.numColumns()));
+    for (int c = 0; c < ds.numColumns(); ++c)
+        ds.forEachValue(c, [&](uint64_t i, double v) { data[i][c] = v; });
+    return true;
+}
+
+// Load a dataset straight into the float rows of the batched path, centered
+// on the column means (returned in shift), without a double copy first
+bool loadDatasetFloat(const string& path, FloatMatrix& X, Vector& shift) {
+    INSTR_SCOPE("io");
+    Dataset ds;
+    if (!ds.open(path)) return false;
+    if (ds.numColumns() == 0 || ds.numRows() == 0) {
+        cerr << path << ": empty dataset" << endl;
+        return false;
+    }
+    X.rows = ds.numRows();
+    X.cols = ds.numColumns();
+    X.values.resize((size_t)X.rows * X.cols);
+    shift.assign(X.cols, 0.0);
+    for (int c = 0; c < X.cols; ++c) {
+        ds.forEachValue(c, [&](uint64_t, double v) { shift[c] += v; });
+        shift[c] /= X.rows;
+        ds.forEachValue(c, [&](uint64_t i, double v) { X.row(i)[c] = (float)(v - shift[c]); });
     }
+    return true;
+}
 
+// Example usage: ./vector_quan [dataset.bin] [--float32] [--codewords=N]
+int main(int argc, char** argv) {
+    string path;
+    bool useFloat = false;
     int numCentroids = 8;
-    Matrix codebook = vectorQuantization(data, numCentroids);
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--float32") useFloat = true;
+        else if (arg.compare(0, 12, "--codewords=") == 0) numCentroids = atoi(arg.c_str() + 12);
+        else path = arg;
+    }
+    if (numCentroids < 1) {
+        cerr << "--codewords must be positive" << endl;
+        return 1;
+    }
+
+    // With --float32 and a dataset, training reads float rows loaded straight
+    // from the file; the double rows for the comparisons are loaded after
+    // training, so the two copies never coexist
+    Matrix data;
+    FloatMatrix floatData;
+    Vector shift;
+    if (!path.empty()) {
+        if (useFloat ? !loadDatasetFloat(path, floatData, shift) : !loadDataset(path, data)) return 1;
+    } else {
+        // Generate synthetic 2D data
+        for (int i = 0; i < 1000; ++i) {
+            double x = (double)rand() / RAND_MAX;
+            double y = (double)rand() / RAND_MAX;
+            data.push_back({x, y});
+        }
+    }
+
+    if (useFloat && floatData.rows == 0) {
+        shift = computeMean(data);
+        floatData = toFloat(data, shift);
+    }
+
+    auto trainStart = chrono::steady_clock::now();
+    vector<Matrix> levels;
+    Matrix codebook = useFloat ? vectorQuantizationFloat(floatData, shift, numCentroids, 100, 1e-5, &levels)
+                               : vectorQuantization(data, numCentroids, 100, 1e-5, &levels);
+    double trainSeconds = chrono::duration<double>(chrono::steady_clock::now() - trainStart).count();
+    floatData = FloatMatrix();
+    if (data.empty() && !loadDataset(path, data)) return 1;
     Matrix quantizedData = quantize(data, codebook);
 
-    // Print codebook
-    cout << "Codebook vectors:\n";
-    for (const auto& vec : codebook) {
-        for (auto val : vec)
-            cout << val << " ";
-        cout << endl;
+    // Print codebook (low-dimensional data only)
+    cout << "LBG training (" << (useFloat ? "float32 batched" : "double") << "): "
+         << trainSeconds << " s, " << data.size() << " vectors of dimension " << data[0].size() << endl;
+    if (data[0].size() <= 8) {
+        cout << "Codebook vectors:\n";
+        for (const auto& vec : codebook) {
+            for (auto val : vec)
+                cout << val << " ";
+            cout << endl;
+        }
     }
 
+    // Compare fast encoders against exact full search. The tree is the LBG
+    // split hierarchy, so its leaves are the same codebook; the stages
+    // share the same number of bits.
+    CodeTree tree = treeFromLevels(levels);
+    int numStages = 2;
+    vector<Matrix> stages = buildMultistageCodebook(data, numStages, codebook.size());
+    double bits = log2((double)codebook.size());
+
+    cout << "\nEncoding quality (" << codebook.size() << " codewords, tree depth "
+         << tree.depth << ", " << numStages << " stages):\n";
+    reportQuality("Full search (LBG)", bits, data, [&] { return quantize(data, codebook); });
+    reportQuality("Full search (float32 batched)", bits, data, [&] { return quantizeFloat(data, codebook); });
+    reportQuality("Tree search", bits, data, [&] { return quantizeTree(data, tree); });
+    reportQuality("Multistage", vq::multistageBits(stages), data, [&] { return quantizeMultistage(data, stages); });
+
+    INSTR_REPORT("vector_quan_profile.json");
     return 0;
 }
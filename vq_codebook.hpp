@@ -0,0 +1,252 @@
+#ifndef VQ_CODEBOOK_HPP
+#define VQ_CODEBOOK_HPP
+
+// Codebook structures shared by vector_quan.cpp (double vectors) and
+// vq_image_compression.cpp (float pixel blocks): the LBG split rule,
+// full search, LBG training, tree-structured VQ over the LBG split
+// hierarchy and multistage (residual) VQ.
+// Everything is templated on the component type T of std::vector<T>;
+// distances and means accumulate in double.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "instrument.hpp"
+
+namespace vq {
+
+template <typename T>
+double squaredDistance(const std::vector<T>& a, const std::vector<T>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        double d = (double)a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Mean of the rows of data listed in members
+template <typename T>
+std::vector<T> meanOf(const std::vector<std::vector<T>>& data, const std::vector<int>& members) {
+    std::vector<double> sum(data.empty() ? 0 : data[0].size(), 0.0);
+    for (int idx : members)
+        for (size_t i = 0; i < sum.size(); ++i)
+            sum[i] += data[idx][i];
+    std::vector<T> mean(sum.size());
+    for (size_t i = 0; i < sum.size(); ++i)
+        mean[i] = members.empty() ? T() : (T)(sum[i] / members.size());
+    return mean;
+}
+
+// Perturb a centroid into two for the LBG split. The perturbation is
+// relative, so it scales with the data; the additive term keeps zero
+// components (e.g. zero-mean residuals) from splitting into duplicates.
+template <typename T>
+void splitCentroid(const std::vector<T>& c, double epsilon, std::vector<T>& plus, std::vector<T>& minus) {
+    plus = c;
+    minus = c;
+    for (auto& val : plus) val = (T)(val * (1 + epsilon) + epsilon);
+    for (auto& val : minus) val = (T)(val * (1 - epsilon) - epsilon);
+}
+
+// Index of the nearest codeword (exact full search)
+template <typename T>
+int nearestCodeword(const std::vector<T>& vec, const std::vector<std::vector<T>>& codebook) {
+    INSTR_COUNT("distance_evals", codebook.size());
+    double minDist = std::numeric_limits<double>::max();
+    int bestIdx = 0;
+    for (size_t i = 0; i < codebook.size(); ++i) {
+        double dist = squaredDistance(vec, codebook[i]);
+        if (dist < minDist) {
+            minDist = dist;
+            bestIdx = i;
+        }
+    }
+    return bestIdx;
+}
+
+// ---------------- LBG and tree-structured VQ ----------------
+
+// LBG: start from the data mean, split every codeword with splitCentroid
+// and refine the doubled codebook with k-means, until it has at least
+// numCodewords (so the size is a power of two). If levels is given,
+// (*levels)[l] receives the refined codebook of 2^l codewords; codeword i
+// of level l was split into codewords 2i and 2i+1 of level l+1.
+template <typename T>
+std::vector<std::vector<T>> trainLbg(const std::vector<std::vector<T>>& data, int numCodewords,
+                                     int maxIter = 100, double epsilon = 1e-5,
+                                     std::vector<std::vector<std::vector<T>>>* levels = nullptr) {
+    std::vector<int> all(data.size());
+    for (size_t i = 0; i < data.size(); ++i) all[i] = i;
+    std::vector<std::vector<T>> codebook(1, meanOf(data, all));
+    if (levels != nullptr) levels->assign(1, codebook);
+
+    // Cluster of each vector in the previous iteration, for label_changes
+    std::vector<int> labels(data.size());
+
+    while ((int)codebook.size() < numCodewords) {
+        std::vector<std::vector<T>> split;
+        for (const auto& c : codebook) {
+            std::vector<T> plus, minus;
+            splitCentroid(c, epsilon, plus, minus);
+            split.push_back(plus);
+            split.push_back(minus);
+        }
+        codebook = split;
+        std::fill(labels.begin(), labels.end(), -1);
+
+        for (int iter = 0; iter < maxIter; ++iter) {
+            INSTR_COUNT("iterations", 1);
+            std::vector<std::vector<int>> members(codebook.size());
+            {
+                INSTR_SCOPE("assign");
+                long long changes = 0;
+                for (size_t v = 0; v < data.size(); ++v) {
+                    int best = nearestCodeword(data[v], codebook);
+                    members[best].push_back(v);
+                    if (labels[v] >= 0 && labels[v] != best) ++changes;
+                    labels[v] = best;
+                }
+                INSTR_COUNT("label_changes", changes);
+            }
+
+            // Update; an empty cluster keeps its old centroid
+            INSTR_SCOPE("update");
+            double totalChange = 0.0;
+            for (size_t i = 0; i < codebook.size(); ++i) {
+                if (members[i].empty()) continue;
+                std::vector<T> mean = meanOf(data, members[i]);
+                totalChange += std::sqrt(squaredDistance(codebook[i], mean));
+                codebook[i] = mean;
+            }
+            if (totalChange < epsilon) break;
+        }
+        if (levels != nullptr) levels->push_back(codebook);
+    }
+    return codebook;
+}
+
+// Node of a tree-structured codebook. Leaves carry the index of their
+// codeword in the flat leaf codebook, internal nodes have two children.
+template <typename T>
+struct TreeNode {
+    std::vector<T> centroid;
+    int left = -1, right = -1;
+    int leaf = -1;
+};
+
+template <typename T>
+struct CodeTree {
+    std::vector<TreeNode<T>> nodes;        // nodes[0] is the root
+    std::vector<std::vector<T>> leaves;    // codewords in leaf order
+    int depth = 0;
+};
+
+// TSVQ over the LBG split hierarchy recorded by trainLbg: every codeword of
+// a level is a node whose children are the plus/minus pair it was split
+// into, and the leaves are the final LBG codebook, so tree search and full
+// search use the same codewords. Encoding costs 2 * depth distances.
+template <typename T>
+CodeTree<T> treeFromLevels(const std::vector<std::vector<std::vector<T>>>& levels) {
+    CodeTree<T> tree;
+    tree.depth = levels.size() - 1;
+    std::vector<int> first;   // node index of codeword 0 of each level
+    for (const auto& level : levels) {
+        first.push_back(tree.nodes.size());
+        for (const auto& c : level) {
+            TreeNode<T> node;
+            node.centroid = c;
+            tree.nodes.push_back(node);
+        }
+    }
+    for (int l = 0; l < tree.depth; ++l) {
+        for (size_t i = 0; i < levels[l].size(); ++i) {
+            tree.nodes[first[l] + i].left = first[l + 1] + 2 * i;
+            tree.nodes[first[l] + i].right = first[l + 1] + 2 * i + 1;
+        }
+    }
+    for (size_t i = 0; i < levels.back().size(); ++i)
+        tree.nodes[first[tree.depth] + i].leaf = i;
+    tree.leaves = levels.back();
+    return tree;
+}
+
+// Descend the tree to a leaf, choosing the closer child at each level
+template <typename T>
+int treeSearch(const std::vector<T>& vec, const CodeTree<T>& tree) {
+    int node = 0;
+    int levels = 0;
+    while (tree.nodes[node].leaf < 0) {
+        ++levels;
+        const TreeNode<T>& n = tree.nodes[node];
+        if (squaredDistance(vec, tree.nodes[n.left].centroid) <= squaredDistance(vec, tree.nodes[n.right].centroid))
+            node = n.left;
+        else
+            node = n.right;
+    }
+    INSTR_COUNT("distance_evals", 2 * levels);
+    return tree.nodes[node].leaf;
+}
+
+// ---------------- Multistage (residual) VQ ----------------
+
+// Codewords per stage for numStages stages that together spend the bits
+// of one numCodewords codebook (log2 rounded up, as LBG rounds the size);
+// the bits are split evenly, earlier stages taking the remainder.
+inline std::vector<int> stageSizes(int numCodewords, int numStages) {
+    int bits = 0;
+    while ((1 << bits) < numCodewords) ++bits;
+    std::vector<int> sizes;
+    for (int s = 0; s < numStages; ++s)
+        sizes.push_back(1 << (bits / numStages + (s < bits % numStages ? 1 : 0)));
+    return sizes;
+}
+
+// Train one codebook per stage with train(residuals, sizes[s]); each stage
+// quantizes the residual left by the previous ones, so the product of the
+// stage sizes in effective codewords costs only their sum to search.
+template <typename T, typename Train>
+std::vector<std::vector<std::vector<T>>> buildMultistageCodebook(const std::vector<std::vector<T>>& data,
+                                                                 const std::vector<int>& sizes, Train train) {
+    std::vector<std::vector<std::vector<T>>> stages;
+    std::vector<std::vector<T>> residual = data;
+    for (int size : sizes) {
+        std::vector<std::vector<T>> codebook = train(residual, size);
+        for (auto& vec : residual) {
+            const std::vector<T>& c = codebook[nearestCodeword(vec, codebook)];
+            for (size_t i = 0; i < vec.size(); ++i)
+                vec[i] -= c[i];
+        }
+        stages.push_back(codebook);
+    }
+    return stages;
+}
+
+// Bits per vector of a multistage code: the sum over the stages
+template <typename T>
+double multistageBits(const std::vector<std::vector<std::vector<T>>>& stages) {
+    double bits = 0.0;
+    for (const auto& codebook : stages) bits += std::log2((double)codebook.size());
+    return bits;
+}
+
+// Reconstruction of vec: the chosen codeword of every stage, summed
+template <typename T>
+std::vector<T> multistageApproximation(const std::vector<T>& vec, const std::vector<std::vector<std::vector<T>>>& stages) {
+    std::vector<T> residual(vec);
+    std::vector<T> approx(vec.size(), T());
+    for (const auto& codebook : stages) {
+        const std::vector<T>& c = codebook[nearestCodeword(residual, codebook)];
+        for (size_t i = 0; i < vec.size(); ++i) {
+            approx[i] += c[i];
+            residual[i] -= c[i];
+        }
+    }
+    return approx;
+}
+
+} // namespace vq
+
+#endif
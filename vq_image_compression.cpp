@@ -2,14 +2,20 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <limits>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+
+#include "instrument.hpp"
+#include "vq_codebook.hpp"
 
 using namespace std;
 using namespace cv;
 
 typedef vector<float> Vector;
 typedef vector<Vector> Matrix;
+typedef vq::CodeTree<float> CodeTree;
 
 // Parameters
 const int BLOCK_SIZE = 4;          // 4x4 blocks
@@ -66,24 +72,36 @@ Matrix createCodebook(const Matrix& vectors, int k) {
     for (int i = 0; i < k; ++i)
         codebook.push_back(vectors[rand() % n]);
 
+    vector<int> labels(n, -1);   // previous assignment, for label_changes
     for (int iter = 0; iter < MAX_ITER; ++iter) {
         vector<Matrix> clusters(k);
+        INSTR_COUNT("iterations", 1);
 
         // Assign vectors to nearest codebook vector
-        for (const auto& v : vectors) {
-            float minDist = 1e9;
-            int best = 0;
-            for (int i = 0; i < k; ++i) {
-                float d = euclidean(v, codebook[i]);
-                if (d < minDist) {
-                    minDist = d;
-                    best = i;
+        {
+            INSTR_SCOPE("assign");
+            long long changes = 0;
+            for (int j = 0; j < n; ++j) {
+                const Vector& v = vectors[j];
+                float minDist = 1e9;
+                int best = 0;
+                for (int i = 0; i < k; ++i) {
+                    float d = euclidean(v, codebook[i]);
+                    if (d < minDist) {
+                        minDist = d;
+                        best = i;
+                    }
                 }
+                clusters[best].push_back(v);
+                if (labels[j] >= 0 && labels[j] != best) ++changes;
+                labels[j] = best;
             }
-            clusters[best].push_back(v);
+            INSTR_COUNT("distance_evals", (long long)n * k);
+            INSTR_COUNT("label_changes", changes);
         }
 
         // Recalculate centroids
+        INSTR_SCOPE("update");
         for (int i = 0; i < k; ++i) {
             if (!clusters[i].empty())
                 codebook[i] = computeMean(clusters[i]);
@@ -95,6 +113,8 @@ Matrix createCodebook(const Matrix& vectors, int k) {
 
 // Compress image using VQ
 vector<int> compress(const vector<Vector>& vectors, const Matrix& codebook) {
+    INSTR_SCOPE("encode_full");
+    INSTR_COUNT("distance_evals", (long long)vectors.size() * codebook.size());
     vector<int> indices;
     for (const auto& v : vectors) {
         float minDist = 1e9;
@@ -111,8 +131,65 @@ vector<int> compress(const vector<Vector>& vectors, const Matrix& codebook) {
     return indices;
 }
 
+// Compress image by descending the codebook tree (2 * log2(k) distances instead of k)
+vector<int> compressTree(const vector<Vector>& vectors, const CodeTree& tree) {
+    INSTR_SCOPE("encode_tree");
+    vector<int> indices;
+    for (const auto& v : vectors)
+        indices.push_back(vq::treeSearch(v, tree));
+    return indices;
+}
+
+// Residual VQ: k-means codebooks on the blocks, then on what is left, with
+// the bits of a k-codeword codebook split over the stages
+vector<Matrix> createMultistageCodebook(const Matrix& vectors, int numStages, int k) {
+    return vq::buildMultistageCodebook(vectors, vq::stageSizes(k, numStages), [&](const Matrix& residual, int size) {
+        return createCodebook(residual, size);
+    });
+}
+
+// Reconstructed blocks: the sum of the chosen codeword of every stage
+Matrix compressMultistage(const vector<Vector>& vectors, const vector<Matrix>& stages) {
+    INSTR_SCOPE("encode_multistage");
+    Matrix reconstructed;
+    for (const auto& v : vectors)
+        reconstructed.push_back(vq::multistageApproximation(v, stages));
+    return reconstructed;
+}
+
+// Peak signal-to-noise ratio of the reconstruction in dB
+double psnr(const vector<Vector>& vectors, const Matrix& reconstructed) {
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        sum += vq::squaredDistance(vectors[i], reconstructed[i]);
+        count += vectors[i].size();
+    }
+    double mse = sum / count;
+    return mse == 0.0 ? numeric_limits<double>::infinity() : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+// Blocks encoded by indices into codebook
+Matrix lookup(const vector<int>& indices, const Matrix& codebook) {
+    Matrix reconstructed;
+    for (int idx : indices)
+        reconstructed.push_back(codebook[idx]);
+    return reconstructed;
+}
+
+// Time an encoder over the blocks and print its rate and PSNR
+template <typename Encoder>
+void reportQuality(const string& name, double bits, const vector<Vector>& vectors, Encoder encode) {
+    auto start = chrono::steady_clock::now();
+    Matrix reconstructed = encode();
+    auto end = chrono::steady_clock::now();
+    double us = chrono::duration<double, micro>(end - start).count();
+    cout << "  " << name << ": " << bits << " bits/block, PSNR = " << psnr(vectors, reconstructed) << " dB, encode time = " << us << " us" << endl;
+}
+
 // Decompress using indices and codebook
 Mat decompress(const vector<int>& indices, const Matrix& codebook, int h, int w) {
+    INSTR_SCOPE("decode");
     Mat result(h, w, CV_8U);
     int idx = 0;
 
@@ -127,7 +204,11 @@ Mat decompress(const vector<int>& indices, const Matrix& codebook, int h, int w)
 
 int main() {
     // Load grayscale image
-    Mat image = imread("input.png", IMREAD_GRAYSCALE);
+    Mat image;
+    {
+        INSTR_SCOPE("io");
+        image = imread("input.png", IMREAD_GRAYSCALE);
+    }
     if (image.empty()) {
         cerr << "Image not found!" << endl;
         return -1;
@@ -152,12 +233,34 @@ int main() {
     cout << "Compressing..." << endl;
     vector<int> indices = compress(blocks, codebook);
 
+    // Tree-structured and multistage alternatives at the same rate. The tree
+    // is the split hierarchy of an LBG codebook, so tree search is compared
+    // with full search over that same LBG codebook.
+    cout << "Creating LBG tree and multistage codebooks..." << endl;
+    vector<Matrix> levels;
+    Matrix lbgCodebook = vq::trainLbg(blocks, CODEBOOK_SIZE, MAX_ITER, 1e-5, &levels);
+    CodeTree tree = vq::treeFromLevels(levels);
+    int numStages = 2;
+    vector<Matrix> stages = createMultistageCodebook(blocks, numStages, CODEBOOK_SIZE);
+    double bits = log2((double)CODEBOOK_SIZE);
+
+    cout << "Encoding quality (" << CODEBOOK_SIZE << " codewords, tree depth " << tree.depth << ", "
+         << numStages << " stages):" << endl;
+    reportQuality("Full search (k-means)", bits, blocks, [&] { return lookup(compress(blocks, codebook), codebook); });
+    reportQuality("Full search (LBG)", bits, blocks, [&] { return lookup(compress(blocks, lbgCodebook), lbgCodebook); });
+    reportQuality("Tree search (LBG)", bits, blocks, [&] { return lookup(compressTree(blocks, tree), tree.leaves); });
+    reportQuality("Multistage", vq::multistageBits(stages), blocks, [&] { return compressMultistage(blocks, stages); });
+
     cout << "Decompressing..." << endl;
     Mat reconstructed = decompress(indices, codebook, h, w);
 
     // Save output
-    imwrite("compressed.png", reconstructed);
+    {
+        INSTR_SCOPE("io");
+        imwrite("compressed.png", reconstructed);
+    }
 
     cout << "Done. Saved to compressed.png" << endl;
+    INSTR_REPORT("vq_image_compression_profile.json");
     return 0;
 }